@@ -0,0 +1,333 @@
+//C standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+//system headers
+#include <unistd.h>
+
+//local headers
+#include "common.h"
+#include "caps.h"
+#include "event.h"
+#include "input.h"
+#include "data.h"
+#include "display.h"
+#include "state.h"
+#include "latency.h"
+#include "diag.h"
+#include "render.h"
+#include "arena.h"
+#include "stats.h"
+
+
+/*
+ *  NOTE: Renders the menu on a render backend without a controller, the
+ *        mem backend unless another is given. On the mem backend every
+ *        frame is first checked: the screen drawn from what changed must
+ *        match the screen drawn whole, & the main menu must highlight
+ *        the selected option only. Then frames are timed.
+ */
+
+// -- [macros] --
+
+//command line usage
+#define USAGE "Usage: menu_bench [-r curses|ansi|mem] [-n frames]"
+
+//frames timed unless told otherwise
+#define BENCH_FRAMES 100000
+
+//main menu options checked, in order
+#define CHECK_OPT_NUM 3
+
+
+// -- [data] --
+
+//benchmark inputs
+enum bench_action {
+    BENCH_UP,
+    BENCH_DOWN,
+    BENCH_ACTIVATE,
+    BENCH_EXIT
+};
+
+
+// -- [globals] --
+
+//event loop the subsystems report to, it is never run
+static struct ev_loop _bench_loop;
+
+//benchmark inputs: walk the main menu, scroll diagnostics & leave them
+static const enum bench_action _bench_actions[] = {
+    BENCH_DOWN, BENCH_DOWN, BENCH_UP, BENCH_DOWN, BENCH_ACTIVATE,
+    BENCH_DOWN, BENCH_UP, BENCH_EXIT, BENCH_UP, BENCH_UP
+};
+
+#define BENCH_ACTION_NUM \
+    ((int) (sizeof(_bench_actions) / sizeof(_bench_actions[0])))
+
+//main menu options, from the top
+static const char * _check_opts[CHECK_OPT_NUM] = {"PLAY", "INFO",
+                                                  "DIAGNOSTICS"};
+
+
+// -- [text] --
+
+//ignore changes, every frame is drawn anyway
+static void _on_change() {
+
+    return;
+}
+
+
+//follow ROM list changes, every frame is drawn anyway
+static void _on_roms_change(bool is_changed) {
+
+    if (is_changed == true) handle_roms_change();
+    return;
+}
+
+
+//apply a benchmark input & render the frame it causes
+static void _bench_frame(int step) {
+
+    switch (_bench_actions[step % BENCH_ACTION_NUM]) {
+
+        case BENCH_UP:       handle_move(-1);   break;
+        case BENCH_DOWN:     handle_move(1);    break;
+        case BENCH_ACTIVATE: handle_activate(); break;
+        case BENCH_EXIT:     handle_exit();     break;
+
+    } //end switch
+
+    redraw();
+    disp_refresh();
+
+    return;
+}
+
+
+//get the heap allocations the display made to draw
+static uint64_t _get_draw_allocs() {
+
+    return arena_blk_count() + rnd_alloc_count();
+}
+
+
+//print the in-memory screen, characters only
+static void _print_screen(const rnd_cell * cells, int sz_y, int sz_x) {
+
+    for (int y = 0; y < sz_y; ++y) {
+        for (int x = 0; x < sz_x; ++x)
+            fputc(RND_CELL_CH(cells[(y * sz_x) + x]), stderr);
+        fputc('\n', stderr);
+    }
+
+    return;
+}
+
+
+//find the colour pair of a word on the in-memory screen, -1 if not shown
+static int _find_pair(const rnd_cell * cells, int sz_y, int sz_x,
+                      const char * word) {
+
+    int len, pair;
+
+
+    len = strlen(word);
+    for (int y = 0; y < sz_y; ++y) {
+        for (int x = 0; x + len <= sz_x; ++x) {
+
+            //the word is drawn in one colour pair
+            pair = RND_CELL_PAIR(cells[(y * sz_x) + x]);
+            for (int i = 0; i < len && pair != -1; ++i) {
+                if (RND_CELL_CH(cells[(y * sz_x) + x + i]) != word[i]
+                    || RND_CELL_PAIR(cells[(y * sz_x) + x + i]) != pair)
+                    pair = -1;
+            }
+            if (pair != -1) return pair;
+        }
+    }
+
+    return -1;
+}
+
+
+//check the main menu highlights its selected option only
+static bool _check_main_menu(const rnd_cell * cells, int sz_y, int sz_x) {
+
+    int pair, sel_pair;
+
+
+    if (menu_state.current_win != MAIN
+        || menu_state.main_menu_pos >= CHECK_OPT_NUM) return true;
+
+    sel_pair = _find_pair(cells, sz_y, sz_x,
+                          _check_opts[menu_state.main_menu_pos]);
+    if (sel_pair == -1) return false;
+
+    for (int i = 0; i < CHECK_OPT_NUM; ++i) {
+
+        if (i == menu_state.main_menu_pos) continue;
+        pair = _find_pair(cells, sz_y, sz_x, _check_opts[i]);
+        if (pair == -1 || pair == sel_pair) return false;
+    }
+
+    return true;
+}
+
+
+//check each benchmark frame on the in-memory screen, return 0 on success
+static int _run_check() {
+
+    int sz_y, sz_x;
+    size_t screen_sz;
+
+    rnd_cell * drawn;
+    const rnd_cell * screen;
+
+
+    screen = rnd_mem_screen(&sz_y, &sz_x);
+    screen_sz = sizeof(rnd_cell) * sz_y * sz_x;
+    drawn = malloc(screen_sz);
+    if (drawn == NULL) FATAL_FAIL("Failed to allocate a screen copy.")
+
+    for (int i = 0; i < BENCH_ACTION_NUM * 2; ++i) {
+
+        _bench_frame(i);
+        memcpy(drawn, screen, screen_sz);
+
+        //laying the display out again draws every window whole
+        disp_resize();
+        redraw();
+        disp_refresh();
+        screen = rnd_mem_screen(&sz_y, &sz_x);
+
+        if (memcmp(drawn, screen, screen_sz) != 0) {
+            report_error("Frame %d differs from the frame drawn whole:\n", i);
+            _print_screen(drawn, sz_y, sz_x);
+            goto _run_check_fail;
+        }
+
+        if (_check_main_menu(screen, sz_y, sz_x) == false) {
+            report_error("Frame %d doesn't highlight option %d alone:\n",
+                         i, menu_state.main_menu_pos);
+            _print_screen(screen, sz_y, sz_x);
+            goto _run_check_fail;
+        }
+    }
+
+    free(drawn);
+    return 0;
+
+    _run_check_fail:
+    free(drawn);
+    return -1;
+}
+
+
+//render frames of benchmark inputs, return the time & allocations taken
+static uint64_t _run_bench(int frames, uint64_t * allocs) {
+
+    uint64_t start_us, start_allocs;
+
+
+    //let every window reach its steady state first
+    for (int i = 0; i < BENCH_ACTION_NUM; ++i) _bench_frame(i);
+
+    start_allocs = _get_draw_allocs();
+    start_us     = lat_now_us();
+    for (int i = 0; i < frames; ++i) _bench_frame(i);
+
+    *allocs = _get_draw_allocs() - start_allocs;
+    return lat_now_us() - start_us;
+}
+
+
+//parse the command line, return the frames to time
+static int _parse_args(int argc, char ** argv) {
+
+    int ret, opt, frames;
+
+
+    frames = BENCH_FRAMES;
+    rnd_select("mem");
+
+    while ((opt = getopt(argc, argv, "r:n:")) != -1) {
+
+        switch (opt) {
+
+            //render backend
+            case 'r':
+                ret = rnd_select(optarg);
+                if (ret != 0) FATAL_FAIL(USAGE)
+                break;
+
+            //frames
+            case 'n':
+                frames = atoi(optarg);
+                if (frames <= 0) FATAL_FAIL(USAGE)
+                break;
+
+            default:
+                FATAL_FAIL(USAGE)
+
+        } //end switch
+    }
+
+    return frames;
+}
+
+
+int main(int argc, char ** argv, char ** envp) {
+
+    int ret, frames;
+    bool is_mem;
+    uint64_t bench_us, bench_allocs;
+
+
+    frames = _parse_args(argc, argv);
+    is_mem = (strcmp(rnd_name(), "mem") == 0);
+
+    //initialise core data
+    init_subsys_state();
+    init_lat();
+    init_ev_loop(&_bench_loop);
+    init_udev();
+    init_caps();
+    init_roms(&_bench_loop, _on_roms_change);
+    init_js(&_bench_loop, _on_change);
+    init_diag(&_bench_loop, _on_change);
+    init_stats(&_bench_loop, _on_change);
+    init_menu_state();
+    init_execve_params(envp);
+    init_disp();
+
+    redraw();
+    disp_refresh();
+
+    //only the in-memory screen can be checked
+    ret = (is_mem == true) ? _run_check() : 0;
+    bench_us = bench_allocs = 0;
+    if (ret == 0) bench_us = _run_bench(frames, &bench_allocs);
+
+    //release core data
+    fini_disp();
+    fini_stats();
+    fini_diag();
+    fini_js();
+    fini_roms();
+    fini_caps();
+    fini_udev();
+    fini_ev_loop(&_bench_loop);
+
+    //report once the terminal is released
+    if (ret != 0) return -1;
+    printf("%s: %s, %d frames, %.2f us/frame, %.2f allocs/frame\n",
+           rnd_name(), (is_mem == true) ? "checked" : "unchecked", frames,
+           (double) bench_us / frames, (double) bench_allocs / frames);
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+//C standard library
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//local headers
+#include "common.h"
+#include "arena.h"
+
+
+/*
+ *  NOTE: An arena only allocates a block when what it holds between
+ *        two resets outgrows every block it has, so an arena refilled
+ *        with the same contents stops allocating after the first fill.
+ *        Arenas belong to the menu thread, as does the block count.
+ */
+
+// -- [globals] --
+
+//blocks allocated by every arena
+static uint64_t _blk_count;
+
+
+// -- [text] --
+
+//allocate a block of at least `sz` bytes
+static struct arena_blk * _new_blk(size_t sz) {
+
+    struct arena_blk * blk;
+
+
+    blk = malloc(sizeof(*blk) + sz);
+    if (blk == NULL) FATAL_FAIL("Failed to allocate an arena block.")
+    _blk_count += 1;
+
+    blk->next = NULL;
+    blk->sz   = sz;
+    blk->used = 0;
+
+    return blk;
+}
+
+
+//initialise an arena of `blk_sz` byte blocks
+void init_arena(struct arena * arena, size_t blk_sz) {
+
+    arena->blk_sz = blk_sz;
+    arena->head   = _new_blk(blk_sz);
+    arena->cur    = arena->head;
+
+    return;
+}
+
+
+//release an arena
+void fini_arena(struct arena * arena) {
+
+    struct arena_blk * blk, * next;
+
+
+    for (blk = arena->head; blk != NULL; blk = next) {
+        next = blk->next;
+        free(blk);
+    }
+    arena->head = arena->cur = NULL;
+
+    return;
+}
+
+
+//allocate `sz` bytes, valid until the arena is reset
+void * arena_alloc(struct arena * arena, size_t sz) {
+
+    void * mem;
+    struct arena_blk * blk;
+
+
+    //keep every allocation aligned for any type
+    sz = (sz + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+
+    //move on to the next kept block, or add one, until `sz` fits
+    blk = arena->cur;
+    while (blk->sz - blk->used < sz) {
+
+        if (blk->next == NULL)
+            blk->next = _new_blk((sz > arena->blk_sz) ? sz : arena->blk_sz);
+
+        blk = blk->next;
+        blk->used = 0;
+    }
+    arena->cur = blk;
+
+    mem = blk->mem + blk->used;
+    blk->used += sz;
+
+    return mem;
+}
+
+
+//free everything allocated, keeping the blocks
+void arena_reset(struct arena * arena) {
+
+    //later blocks are cleared as the arena reaches them
+    arena->cur = arena->head;
+    arena->head->used = 0;
+
+    return;
+}
+
+
+//get the blocks allocated by every arena so far
+uint64_t arena_blk_count() {
+
+    return _blk_count;
+}
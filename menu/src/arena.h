@@ -0,0 +1,48 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+//C standard library
+#include <stddef.h>
+#include <stdint.h>
+
+
+// -- [data] --
+
+//arena block
+struct arena_blk {
+
+    struct arena_blk * next;
+    size_t sz;
+    size_t used;
+
+    _Alignas(max_align_t) char mem[];
+};
+
+
+//bump allocator, its blocks are kept across resets
+struct arena {
+
+    size_t blk_sz;
+
+    struct arena_blk * head;
+    struct arena_blk * cur; //block allocated from
+};
+
+
+// -- [text] --
+
+//initialise & release an arena of `blk_sz` byte blocks
+void init_arena(struct arena * arena, size_t blk_sz);
+void fini_arena(struct arena * arena);
+
+//allocate `sz` bytes, valid until the arena is reset
+void * arena_alloc(struct arena * arena, size_t sz);
+
+//free everything allocated, keeping the blocks
+void arena_reset(struct arena * arena);
+
+//get the blocks allocated by every arena so far
+uint64_t arena_blk_count();
+
+
+#endif
@@ -0,0 +1,240 @@
+//C standard library
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+//system headers
+#include <unistd.h>
+
+//external libraries
+#include <cmore.h>
+
+//local headers
+#include "common.h"
+#include "caps.h"
+#include "input.h"
+
+
+/*
+ *  NOTE: Entries are matched by identity, one per model. A controller
+ *        that reports no vendor or product can't be told apart from
+ *        others that don't, so it is never cached & always probed. The
+ *        file holds a header followed by fixed size records; a file
+ *        with an unknown magic or version is ignored & rewritten on the
+ *        next store.
+ */
+
+// -- [data] --
+
+//cached controller capabilities
+struct caps_entry {
+
+    struct caps_id id;
+    bool keys[KEY_OPT_NUM];
+};
+
+//on-disk file header
+struct caps_hdr {
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+};
+
+//on-disk record, keys are stored as a bitmap
+struct caps_rec {
+
+    struct caps_id id;
+    uint32_t keys;
+};
+
+
+// -- [globals] --
+
+//in-memory cache
+static cm_vct _caps; //type: struct caps_entry
+
+
+// -- [text] --
+
+//compare two controller identities
+static bool _caps_id_eq(const struct caps_id * a, const struct caps_id * b) {
+
+    return a->bustype == b->bustype && a->vendor == b->vendor
+           && a->product == b->product && a->version == b->version;
+}
+
+
+//check if an identity tells a model apart, missing attributes read as 0
+static bool _caps_id_is_known(const struct caps_id * id) {
+
+    return id->vendor != 0 || id->product != 0;
+}
+
+
+//read the cache file, a missing or invalid file leaves the cache empty
+static void _load_caps() {
+
+    int ret;
+    size_t count;
+    FILE * file;
+
+    struct caps_hdr hdr;
+    struct caps_rec rec;
+    struct caps_entry entry;
+
+
+    file = fopen(PATH_CAPS, "rb");
+    if (file == NULL) return;
+
+    count = fread(&hdr, sizeof(hdr), 1, file);
+    if (count != 1 || hdr.magic != CAPS_MAGIC
+        || hdr.version != CAPS_VERSION) goto _load_caps_cleanup;
+
+    for (uint32_t i = 0; i < hdr.count; ++i) {
+
+        count = fread(&rec, sizeof(rec), 1, file);
+        if (count != 1) break;
+        if (_caps_id_is_known(&rec.id) == false) continue;
+
+        entry.id = rec.id;
+        for (int j = 0; j < KEY_OPT_NUM; ++j) {
+            entry.keys[j] = ((rec.keys >> j) & 1) == 1;
+        }
+
+        ret = cm_vct_apd(&_caps, &entry);
+        if (ret != 0) break;
+    }
+
+    _load_caps_cleanup:
+    fclose(file);
+    return;
+}
+
+
+//write the cache file, replacing the old one atomically
+static void _save_caps() {
+
+    int ret;
+    size_t count;
+    FILE * file;
+
+    struct caps_hdr hdr;
+    struct caps_rec rec;
+    struct caps_entry * entry;
+
+
+    //a failed save only costs a probe on the next boot
+    file = fopen(PATH_CAPS ".tmp", "wb");
+    if (file == NULL) return;
+
+    hdr.magic   = CAPS_MAGIC;
+    hdr.version = CAPS_VERSION;
+    hdr.count   = _caps.len;
+
+    count = fwrite(&hdr, sizeof(hdr), 1, file);
+    if (count != 1) goto _save_caps_cleanup;
+
+    for (int i = 0; i < _caps.len; ++i) {
+
+        entry = cm_vct_get_p(&_caps, i);
+        memset(&rec, 0, sizeof(rec));
+        rec.id = entry->id;
+        for (int j = 0; j < KEY_OPT_NUM; ++j) {
+            if (entry->keys[j] == true) rec.keys |= (1u << j);
+        }
+
+        count = fwrite(&rec, sizeof(rec), 1, file);
+        if (count != 1) goto _save_caps_cleanup;
+    }
+
+    ret = fclose(file);
+    if (ret != 0) goto _save_caps_unlink;
+    rename(PATH_CAPS ".tmp", PATH_CAPS);
+    return;
+
+    _save_caps_cleanup:
+    fclose(file);
+
+    _save_caps_unlink:
+    unlink(PATH_CAPS ".tmp");
+    return;
+}
+
+
+//initialise the capability cache, loading it from disk
+void init_caps() {
+
+    int ret;
+
+
+    ret = cm_new_vct(&_caps, sizeof(struct caps_entry));
+    if (ret != 0) FATAL_FAIL("Failed to initialise the capability cache.");
+
+    _load_caps();
+    return;
+}
+
+
+//release the capability cache
+void fini_caps() {
+
+    cm_del_vct(&_caps);
+    return;
+}
+
+
+//fetch the cached keymap of a controller, returns false if it's unknown
+bool caps_lookup(const struct caps_id * id, bool * keys) {
+
+    struct caps_entry * entry;
+
+
+    if (_caps_id_is_known(id) == false) return false;
+
+    for (int i = 0; i < _caps.len; ++i) {
+
+        entry = cm_vct_get_p(&_caps, i);
+        if (_caps_id_eq(&entry->id, id) == false) continue;
+
+        memcpy(keys, entry->keys, sizeof(entry->keys));
+        return true;
+    }
+
+    return false;
+}
+
+
+//cache the keymap of a controller, saving the cache to disk if it changed
+void caps_store(const struct caps_id * id, const bool * keys) {
+
+    int ret;
+    struct caps_entry * entry, new_entry;
+
+
+    if (_caps_id_is_known(id) == false) return;
+
+    //update an existing entry
+    for (int i = 0; i < _caps.len; ++i) {
+
+        entry = cm_vct_get_p(&_caps, i);
+        if (_caps_id_eq(&entry->id, id) == false) continue;
+
+        if (memcmp(entry->keys, keys, sizeof(entry->keys)) == 0) return;
+
+        memcpy(entry->keys, keys, sizeof(entry->keys));
+        _save_caps();
+        return;
+    }
+
+    //add a new entry
+    new_entry.id = *id;
+    memcpy(new_entry.keys, keys, sizeof(new_entry.keys));
+
+    ret = cm_vct_apd(&_caps, &new_entry);
+    if (ret != 0) return;
+
+    _save_caps();
+    return;
+}
@@ -0,0 +1,44 @@
+#ifndef CAPS_H
+#define CAPS_H
+
+//C standard library
+#include <stdbool.h>
+#include <stdint.h>
+
+//local headers
+#include "common.h"
+
+
+// -- [macros] --
+
+//capability cache file format
+#define CAPS_MAGIC   0x53504350 //"SPCP"
+#define CAPS_VERSION 1
+
+
+// -- [data] --
+
+//controller identity, as reported by the kernel
+struct caps_id {
+
+    uint16_t bustype;
+    uint16_t vendor;
+    uint16_t product;
+    uint16_t version;
+};
+
+
+// -- [text] --
+
+//initialise & release the capability cache, loading it from disk
+void init_caps();
+void fini_caps();
+
+//fetch the cached keymap of a controller, returns false if it's unknown
+bool caps_lookup(const struct caps_id * id, bool * keys);
+
+//cache the keymap of a controller, saving the cache to disk if it changed
+void caps_store(const struct caps_id * id, const bool * keys);
+
+
+#endif
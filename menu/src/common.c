@@ -3,6 +3,9 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
 
 //local headers
 #include "common.h"
@@ -41,10 +44,21 @@ int int_clamp(int val, int min, int max) {
 }
 
 
+//get the monotonic clock in milliseconds
+uint64_t mono_ms() {
+
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+
 //initialise global subsystem status struct 
 void init_subsys_state() {
 
-    subsys_state.udev_good   = true;
+    atomic_init(&subsys_state.udev_good, true);
     subsys_state.rom_good    = true;
     subsys_state.execve_good = true;
 
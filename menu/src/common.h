@@ -5,6 +5,8 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
 
 
 // -- [macros] --
@@ -14,7 +16,13 @@
 
 //paths DEBUG
 //#define PATH_ROMS "/superpi/rom"
+//#define PATH_CAPS "/superpi/caps.cache"
+//#define PATH_ROMS_IDX "/superpi/roms.idx"
+//#define PATH_LAT "/superpi/latency.txt"
 #define PATH_ROMS "/home/vykt/projects/super-pi/menu/roms"
+#define PATH_CAPS "/home/vykt/projects/super-pi/menu/caps.cache"
+#define PATH_ROMS_IDX "/home/vykt/projects/super-pi/menu/roms.idx"
+#define PATH_LAT "/home/vykt/projects/super-pi/menu/latency.txt"
 
 //colours
 #define RESET   "\x1b[0m"
@@ -35,7 +43,7 @@
 
 //status of subsystems
 struct subsys_state {
-    bool udev_good;
+    atomic_bool udev_good; //written by the device thread
     bool rom_good;
     bool execve_good;
 };
@@ -55,6 +63,9 @@ void report_error(const char * fmt, ...);
 //clamp an integer between some range
 int int_clamp(int val, int min, int max);
 
+//get the monotonic clock in milliseconds
+uint64_t mono_ms();
+
 //initialise global subsystem status struct 
 void init_subsys_state();
 
@@ -1,10 +1,25 @@
 //C standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <time.h>
 
 //system headers
+#include <unistd.h>
+#include <fcntl.h>
 #include <dirent.h>
+#include <pthread.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/types.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/resource.h>
 
 //kernel headers
 #include <linux/limits.h>
@@ -15,6 +30,156 @@
 //local headers
 #include "common.h"
 #include "data.h"
+#include "event.h"
+
+
+/*
+ *  NOTE: The ROM list holds the path of every ROM below the ROMs
+ *        directory, relative to it & sorted, so the contents of any
+ *        folder are a single run of the list. It starts as the index
+ *        written by the last run, then is kept current from inotify
+ *        events, each adding or removing a single path. Walking the
+ *        tree & writing the index may stall on a busy SD card, so both
+ *        are left to a scanner thread. At startup & when a folder
+ *        appears or goes away, the thread checks the folders it last
+ *        read against their timestamps & reads again only those that
+ *        changed, & the new folders below them. The tree is walked
+ *        whole if the index is missing or events were lost. A walk's
+ *        result replaces the list in one swap on the menu's loop, a
+ *        check's result replaces only the ROMs of the folders read.
+ */
+
+// -- [macros] --
+
+//directory timestamps this recent may not reflect the latest change
+#define ROMS_MTIME_SLACK_S 2
+
+//events watched in every folder of the ROMs directory
+#define ROMS_WATCH_MASK (IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO \
+                         | IN_DELETE | IN_MOVED_FROM \
+                         | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+
+//inotify read buffer size, fits many events with names
+#define ROMS_EVENT_BUF_SZ (64 * (sizeof(struct inotify_event) + NAME_MAX + 1))
+
+//size of the events held during a walk, more are lost & walked again
+#define ROMS_PENDING_SZ (4 * ROMS_EVENT_BUF_SZ)
+
+//interval between reports of a walk's progress
+#define ROMS_PROGRESS_MS 100
+
+//delay before writing the index, so a burst of changes is written once
+#define ROMS_IDX_SAVE_MS 1000
+
+//most threads reading folders during a walk
+#define ROMS_WALK_THREADS_MAX 4
+
+//niceness of the scanner thread & its walkers, the menu is kept responsive
+#define ROMS_WALK_NICE 10
+
+
+// -- [data] --
+
+//folder timestamps as of its last complete read
+struct roms_scan {
+
+    bool is_valid;
+
+    dev_t dev;
+    ino_t ino;
+    struct timespec mtim;
+    struct timespec ctim;
+};
+
+
+//folder of the ROMs directory
+struct roms_dir {
+
+    char * path;         //relative to the ROMs directory, "" for itself
+    struct roms_scan scan;
+    int wd;              //inotify watch, -1 if not watched
+};
+
+
+//on-disk index header, followed by `dir_count` folder timestamps &
+//`str_sz` bytes of paths: those of the folders, then `count` ROM paths
+struct roms_idx_hdr {
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t exts_hash; //extensions the paths were matched against
+
+    uint32_t dir_sz;
+    uint32_t dir_count;
+    uint32_t count;
+    uint64_t str_sz;
+};
+
+
+//index waiting to be written
+struct roms_idx_job {
+
+    struct roms_idx_hdr hdr;
+    char * recs; //`hdr.dir_count` timestamps, then every path terminated
+};
+
+
+//walk of the ROMs directory
+struct roms_walk {
+
+    unsigned int gen; //request the walk answers
+    bool is_good;     //false if the tree couldn't be read
+    bool is_current;  //true if the tree is unchanged, `paths` is empty
+    bool is_partial;  //true if only the folders in `stale` were read
+
+    cm_vct dirs;  //type: struct roms_dir, sorted
+    cm_vct paths; //type: char *, sorted
+    cm_vct stale; //type: char *, sorted, folders whose ROMs `paths` replace
+};
+
+
+//folders waiting to be read by a walk's threads
+struct roms_walk_queue {
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    cm_vct dirs; //type: char *
+    int busy;    //threads reading a folder
+
+    atomic_bool is_stopped;
+    bool is_failed;
+
+    int root_fd;
+    cm_vct * known; //type: char *, sorted, read apart, NULL if none
+};
+
+
+//thread reading folders during a walk & what it found
+struct roms_walker {
+
+    pthread_t thread;
+    struct roms_walk_queue * queue;
+
+    cm_vct dirs;  //type: struct roms_dir
+    cm_vct paths; //type: char *
+};
+
+
+//items of the open folder, found in its run of the ROMs vector
+struct rom_view {
+
+    bool is_counted;
+
+    int first; //run of the folder's paths
+    int end;
+    int dir_num;
+    int file_num;
+
+    //last item found & the start of its paths, -1 if none
+    int cur_item;
+    int cur_idx;
+};
 
 
 // -- [globals] --
@@ -22,95 +187,2322 @@
 //cmore vector of rom pathnames
 cm_vct rom_basenames;
 
+//open rom folder & its items
+char rom_folder[ROMS_PATH_MAX];
+unsigned long rom_items_gen;
+static size_t _rom_folder_len;
+static struct rom_view _rom_view;
+
+//ROM extensions, lowercase & without the dot
+static char _roms_exts[ROMS_EXT_MAX][ROMS_EXT_LEN];
+static int _roms_ext_num;
+
+//folders of the ROMs directory as of the last complete walk
+static cm_vct _roms_dirs; //type: struct roms_dir, sorted
+
+//index loaded at startup, paths taken from it point into the mapping
+static void * _roms_idx_map = MAP_FAILED;
+static size_t _roms_idx_sz;
+
+//inotify instance watching every folder, -1 if none are watched
+static int _roms_watch_fd = -1;
+
+//the menu's loop & its receiver of ROM list changes
+static struct ev_loop * _roms_loop;
+static roms_change_cb _roms_change_cb;
+
+//whether the ROMs directory itself is watched & the ROM count
+static bool _roms_is_watched;
+static atomic_int _roms_count;
+
+//timer writing the index & whether the index is out of date
+static int _roms_save_fd = -1;
+static bool _roms_idx_is_stale;
+
+//check or walk requested, sent once the one in progress is applied
+static bool _roms_want_check;
+static bool _roms_want_walk;
+
+//events read during a walk & whether any didn't fit
+static _Alignas(struct inotify_event) char _roms_pending[ROMS_PENDING_SZ];
+static size_t _roms_pending_len;
+static bool _roms_pending_lost;
+
+//scanner thread & its event loop
+static pthread_t _scan_thread;
+static struct ev_loop _scan_loop;
+
+//scanner thread stop, walk, stamp & write requests
+static int _scan_stop_fd  = -1;
+static int _scan_walk_fd  = -1;
+static int _scan_stamp_fd = -1;
+static int _scan_write_fd = -1;
+static atomic_bool _scan_is_stopped;
+
+//the menu's notification source of walk results & progress
+static int _scan_ready_fd = -1;
+
+//latest walk requested, latest walk applied by the menu
+static atomic_uint _scan_req_gen;
+static unsigned int _scan_done_gen;
+
+//whether the latest request must walk, rather than check the folders
+static atomic_bool _scan_need_walk;
+
+//ROMs found so far by the walk in progress
+static atomic_int _scan_found;
+
+//folders the scanner thread last read, checked before walking
+static cm_vct _scan_dirs; //type: struct roms_dir, sorted
+
+//walk result, folder stamps & index handed between the threads, & their
+//lock
+static pthread_mutex_t _scan_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct roms_walk _scan_result;
+static bool _scan_has_result;
+static cm_vct _scan_stamps; //type: struct roms_dir, sorted
+static bool _scan_has_stamps;
+static struct roms_idx_job _scan_job;
+static bool _scan_has_job;
+
 
 // -- [text] --
 
-//initialise the global ROMs vector
-void init_roms() {
+//hash the ROM extensions, an index matched against others is ignored
+static uint32_t _hash_exts() {
+
+    uint32_t hash;
+
+
+    //FNV-1a
+    hash = 2166136261u;
+    for (int i = 0; i < _roms_ext_num; ++i) {
+        for (const char * c = _roms_exts[i]; ; ++c) {
+            hash = (hash ^ (unsigned char) *c) * 16777619u;
+            if (*c == '\0') break;
+        }
+    }
+
+    return hash;
+}
+
+
+/*
+ *  NOTE: A ROM is a regular file, or a link to one, with one of the
+ *        ROM extensions in any case. The extension is checked first &
+ *        the type is taken from the dirent, so only links & entries of
+ *        filesystems that don't report types cost an fstatat().
+ */
+
+//check if a directory entry is a ROM, `type` is a dirent type
+static bool _is_rom(int dir_fd, const char * name, unsigned char type) {
 
     int ret;
+    bool is_matched;
+    const char * ext;
+    struct stat statbuf;
 
 
-    ret = cm_new_vct(&rom_basenames, sizeof(char[NAME_MAX]));
-    if (ret != 0) FATAL_FAIL("Failed to initialise the ROM vector.");
+    //skip entries without a ROM extension
+    ext = strrchr(name, '.');
+    if (ext == NULL) return false;
+
+    is_matched = false;
+    for (int i = 0; is_matched == false && i < _roms_ext_num; ++i)
+        is_matched = (strcasecmp(ext + 1, _roms_exts[i]) == 0);
+    if (is_matched == false) return false;
+
+    //skip non-regular file entries
+    if (type == DT_REG) return true;
+    if (type != DT_UNKNOWN && type != DT_LNK) return false;
+
+    ret = fstatat(dir_fd, name, &statbuf, 0);
+    return (ret == 0 && S_ISREG(statbuf.st_mode));
+}
+
+
+/*
+ *  NOTE: Paths are allocated one by one & owned by the vector holding
+ *        them, except those loaded from the index, which point into its
+ *        mapping until they're replaced. A path too long to open once
+ *        joined to PATH_ROMS can't be launched either, so it is left
+ *        out.
+ */
+
+//join a folder & a name into `path`, false if the path is too long
+static bool _join_path(char * path, const char * dir, const char * name) {
+
+    int len;
+
+
+    len = snprintf(path, ROMS_PATH_MAX, "%s%s%s",
+                   dir, (dir[0] == '\0') ? "" : "/", name);
+
+    return (len >= 0 && len < ROMS_PATH_MAX);
+}
+
+
+//copy a path, NULL if out of memory
+static char * _dup_path(const char * path) {
+
+    return strdup(path);
+}
+
+
+//release a path, unless it points into the index
+static void _free_path(char * path) {
+
+    uintptr_t addr, map;
+
+
+    addr = (uintptr_t) path;
+    map  = (uintptr_t) _roms_idx_map;
+    if (_roms_idx_map != MAP_FAILED && addr >= map
+        && addr < map + _roms_idx_sz) return;
 
+    free(path);
     return;
 }
 
 
-//release the global ROMs vector
-void fini_roms() {
+//get a path of a vector of paths
+static char * _get_path(cm_vct * paths, int idx) {
+
+    return *(char **) cm_vct_get_p(paths, idx);
+}
+
+
+//find where the first `len` characters of `path` are or would be in a
+//sorted vector of paths
+static int _bound_path(cm_vct * paths, const char * path, size_t len) {
+
+    int low, high, mid, cmp;
+    char * vct_path;
+
+
+    //binary search, a path the key is a prefix of sorts after the key
+    low  = 0;
+    high = paths->len;
+    while (low < high) {
+
+        mid = low + (high - low) / 2;
+        vct_path = _get_path(paths, mid);
+
+        cmp = strncmp(vct_path, path, len);
+        if (cmp < 0) low = mid + 1;
+        else high = mid;
+    }
+
+    return low;
+}
+
+
+//check if the first `len` characters of `path` are in a sorted vector
+static bool _has_path(cm_vct * paths, const char * path, size_t len) {
+
+    int idx;
+    char * vct_path;
+
+
+    idx = _bound_path(paths, path, len);
+    if (idx == paths->len) return false;
+
+    vct_path = _get_path(paths, idx);
+    return strncmp(vct_path, path, len) == 0 && vct_path[len] == '\0';
+}
+
+
+//get the length of the folder part of a ROM path, "" for the top folder
+static size_t _get_parent_len(const char * path) {
+
+    const char * slash;
+
+
+    slash = strrchr(path, '/');
+    return (slash == NULL) ? 0 : (size_t) (slash - path);
+}
+
+
+//release the paths of a vector, emptying it
+static void _empty_paths(cm_vct * paths) {
+
+    for (int i = 0; i < paths->len; ++i) _free_path(_get_path(paths, i));
+    cm_vct_emp(paths);
 
-    cm_del_vct(&rom_basenames);
     return;
 }
 
 
-//repopulate the ROMs vector
-void update_roms() {
+//release a vector of paths
+static void _del_paths(cm_vct * paths) {
+
+    _empty_paths(paths);
+    cm_del_vct(paths);
+
+    return;
+}
+
+
+//release the paths of a vector of folders, emptying it
+static void _empty_dirs(cm_vct * dirs) {
+
+    for (int i = 0; i < dirs->len; ++i)
+        _free_path(((struct roms_dir *) cm_vct_get_p(dirs, i))->path);
+    cm_vct_emp(dirs);
+
+    return;
+}
+
+
+//release a vector of folders
+static void _del_dirs(cm_vct * dirs) {
+
+    _empty_dirs(dirs);
+    cm_del_vct(dirs);
+
+    return;
+}
+
+
+//release the vectors of a walk
+static void _del_walk(struct roms_walk * walk) {
+
+    _del_dirs(&walk->dirs);
+    _del_paths(&walk->paths);
+    _del_paths(&walk->stale);
+
+    return;
+}
+
+
+//append a copy of a path to a vector of paths, return 0 on success
+static int _apd_path(cm_vct * paths, const char * path) {
 
     int ret;
-    size_t len, path_roms_len;
+    char * copy;
 
-    DIR * rom_dir;
-    struct dirent * dirent;
-    struct stat statbuf;
 
-    char pathname_buf[PATH_MAX];
+    copy = _dup_path(path);
+    if (copy == NULL) return -1;
 
+    ret = cm_vct_apd(paths, &copy);
+    if (ret != 0) free(copy);
 
-    //reset error state
-    subsys_state.rom_good = true;
+    return ret;
+}
 
-    //empty the ROMs vector
-    cm_vct_emp(&rom_basenames);
 
-    //open the ROMs directory
-    rom_dir = opendir(PATH_ROMS);
-    if (rom_dir == NULL) {
-        subsys_state.rom_good = false;
-        return;
-    }
+//append a copy of a folder to a vector of folders, return 0 on success
+static int _apd_dir(cm_vct * dirs, const struct roms_dir * roms_dir) {
 
-    //prepare the pathname buffer
-    path_roms_len = strnlen(PATH_ROMS, PATH_MAX);
-    memcpy(pathname_buf, PATH_ROMS, path_roms_len);
-    pathname_buf[path_roms_len] = '/';
+    int ret;
+    struct roms_dir copy;
 
-    //for all directory entries
-    while ((dirent = readdir(rom_dir)) != NULL) {
 
-        //build the pathname for this entry
-        len = strnlen(dirent->d_name, NAME_MAX);
-        if ((path_roms_len + len + 2) > PATH_MAX) {
-            subsys_state.rom_good = false;
-            goto _update_roms_cleanup_dir;
-        }
-        memcpy(pathname_buf + path_roms_len + 1, dirent->d_name, len + 1);
+    copy      = *roms_dir;
+    copy.path = _dup_path(roms_dir->path);
+    if (copy.path == NULL) return -1;
 
-        //skip non-regular file entries
-        ret = stat(pathname_buf, &statbuf);
-        if (ret != 0 || S_ISREG(statbuf.st_mode) == false) continue;
+    ret = cm_vct_apd(dirs, &copy);
+    if (ret != 0) _free_path(copy.path);
 
-        //skip non `.sfc` extension entries
-        if (len < 4) continue;
-        if (strncmp(dirent->d_name + len - 4, ".sfc", NAME_MAX)) continue;
+    return ret;
+}
 
-        //add this basename to the ROM vector
-        ret = cm_vct_apd(&rom_basenames, dirent->d_name);
-        if (ret != 0) {
 
-            //on failure, re-start the vector
-            subsys_state.rom_good = false;
-            fini_roms();
-            init_roms();
+//compare ROM paths, for sorting
+static int _cmp_path(const void * path_a, const void * path_b) {
 
-            goto _update_roms_cleanup_dir;
-        }
+    return strcmp(*(char * const *) path_a, *(char * const *) path_b);
+}
+
+
+//compare folders by path, for sorting
+static int _cmp_dir(const void * dir_a, const void * dir_b) {
+
+    return strcmp(((const struct roms_dir *) dir_a)->path,
+                  ((const struct roms_dir *) dir_b)->path);
+}
+
+
+//find where a path is or would be in the ROMs vector
+static int _bound_rom(const char * path) {
+
+    return _bound_path(&rom_basenames, path, strlen(path));
+}
+
+
+//publish the ROM count to other threads
+static void _publish_count() {
+
+    atomic_store(&_roms_count,
+                 subsys_state.rom_good ? rom_basenames.len : -1);
+    return;
+}
+
+
+//check if a folder is unchanged since its last complete read
+static bool _is_scan_current(const struct roms_scan * scan,
+                             const struct stat * dir_stat) {
+
+    if (scan->is_valid == false) return false;
+
+    return scan->dev == dir_stat->st_dev
+           && scan->ino == dir_stat->st_ino
+           && scan->mtim.tv_sec == dir_stat->st_mtim.tv_sec
+           && scan->mtim.tv_nsec == dir_stat->st_mtim.tv_nsec
+           && scan->ctim.tv_sec == dir_stat->st_ctim.tv_sec
+           && scan->ctim.tv_nsec == dir_stat->st_ctim.tv_nsec;
+}
+
+
+//record a folder's complete read, `dir_stat` taken before it
+static void _set_scan(struct roms_scan * scan, const struct stat * dir_stat) {
+
+    scan->dev  = dir_stat->st_dev;
+    scan->ino  = dir_stat->st_ino;
+    scan->mtim = dir_stat->st_mtim;
+    scan->ctim = dir_stat->st_ctim;
+
+    //a change within the timestamp granularity could go unnoticed
+    scan->is_valid
+        = (time(NULL) - dir_stat->st_mtim.tv_sec) > ROMS_MTIME_SLACK_S
+          && (time(NULL) - dir_stat->st_ctim.tv_sec) > ROMS_MTIME_SLACK_S;
+
+    return;
+}
+
+
+//get the path of a folder of the ROMs directory
+static void _get_dir_path(char * dir_path, const char * path) {
+
+    snprintf(dir_path, PATH_MAX, "%s/%s", PATH_ROMS, path);
+    return;
+}
+
+
+//allocate the ROMs vector again after it failed to grow
+static void _reset_roms() {
+
+    int ret;
+
+
+    _del_paths(&rom_basenames);
+    ret = cm_new_vct(&rom_basenames, sizeof(char *));
+    if (ret != 0) FATAL_FAIL("Failed to initialise the ROM vector.");
+
+    return;
+}
+
+
+/*
+ *  NOTE: The open folder's items aren't stored. Its paths are a run of
+ *        the sorted list & each subfolder's paths are a run within it,
+ *        so items are found by stepping over the run & bounding each
+ *        subfolder "sub/" by "sub0", the first path past it. The items
+ *        are counted once per change & the last one found is kept to
+ *        step from, as the rows in view are asked for in order.
+ */
+
+//get the length of the subfolder prefix of a path of the open folder,
+//with its '/', 0 if the path is in the folder itself
+static int _get_subdir_len(const char * path) {
+
+    char * slash;
+
+
+    slash = strchr(path + _rom_folder_len, '/');
+    return (slash == NULL) ? 0 : slash - path + 1;
+}
+
+
+//find the end of the run of paths starting with the `len` long prefix of
+//`path`, which ends in '/'
+static int _bound_subdir_end(const char * path, int len) {
+
+    char key[ROMS_PATH_MAX];
+
+
+    //'0' follows '/', so "sub0" sorts right after every "sub/" path
+    memcpy(key, path, len);
+    key[len - 1] = '0';
+
+    return _bound_path(&rom_basenames, key, len);
+}
+
+
+//get the start of the open folder's item after the one at `idx`
+static int _next_item_idx(int idx) {
+
+    int len;
+    char * path;
+
+
+    path = _get_path(&rom_basenames, idx);
+    len  = _get_subdir_len(path);
+
+    return (len == 0) ? idx + 1 : _bound_subdir_end(path, len);
+}
+
+
+//get the start of the open folder's item before the one at `idx`
+static int _prev_item_idx(int idx) {
+
+    int len;
+    char * path;
+
+
+    path = _get_path(&rom_basenames, idx - 1);
+    len  = _get_subdir_len(path);
+
+    return (len == 0) ? idx - 1 : _bound_path(&rom_basenames, path, len);
+}
+
+
+//check if the open folder's item at `idx` is a subfolder
+static bool _is_item_dir(int idx) {
+
+    return _get_subdir_len(_get_path(&rom_basenames, idx)) != 0;
+}
+
+
+//find the first item from `idx` on that is, or isn't, a subfolder
+static int _seek_item(int idx, bool is_dir) {
+
+    while (idx < _rom_view.end && _is_item_dir(idx) != is_dir)
+        idx = _next_item_idx(idx);
+
+    return idx;
+}
+
+
+//find the last item before `idx` that is, or isn't, a subfolder
+static int _seek_item_back(int idx, bool is_dir) {
+
+    do {
+        idx = _prev_item_idx(idx);
+    } while (idx > _rom_view.first && _is_item_dir(idx) != is_dir);
+
+    return idx;
+}
+
+
+//count the items of the open folder if the list changed since
+static void _count_items() {
+
+    if (_rom_view.is_counted == true) return;
+
+    _rom_view.first = _bound_rom(rom_folder);
+    _rom_view.end   = (_rom_folder_len == 0)
+                      ? rom_basenames.len
+                      : _bound_subdir_end(rom_folder, _rom_folder_len);
+
+    _rom_view.dir_num  = 0;
+    _rom_view.file_num = 0;
+    for (int i = _rom_view.first; i < _rom_view.end; i = _next_item_idx(i)) {
+        if (_is_item_dir(i) == true) _rom_view.dir_num += 1;
+        else _rom_view.file_num += 1;
     }
 
-    _update_roms_cleanup_dir:
-    closedir(rom_dir);
+    _rom_view.cur_item   = -1;
+    _rom_view.is_counted = true;
 
     return;
 }
+
+
+//forget the open folder's items after the list or the folder changed
+static void _reset_items() {
+
+    _rom_view.is_counted = false;
+    rom_items_gen += 1;
+
+    return;
+}
+
+
+//walk threads: stop the walk, `is_failed` if the tree can't be read whole
+static void _stop_walk(struct roms_walk_queue * queue, bool is_failed) {
+
+    pthread_mutex_lock(&queue->lock);
+    if (is_failed == true) queue->is_failed = true;
+    atomic_store(&queue->is_stopped, true);
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+
+    return;
+}
+
+
+//walk threads: queue a folder to be read
+static void _queue_dir(struct roms_walk_queue * queue, const char * path) {
+
+    int ret;
+    char * queued;
+
+
+    queued = _dup_path(path);
+    if (queued == NULL) {
+        _stop_walk(queue, true);
+        return;
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    ret = cm_vct_apd(&queue->dirs, &queued);
+    pthread_cond_signal(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+
+    if (ret != 0) {
+        free(queued);
+        _stop_walk(queue, true);
+    }
+
+    return;
+}
+
+
+//walk thread: read a folder, queueing its subfolders
+static void _walk_dir(struct roms_walker * walker, const char * path) {
+
+    int ret, fd;
+    unsigned char type;
+    char entry_path[ROMS_PATH_MAX], dir_path[PATH_MAX], * rom_path;
+
+    DIR * dir;
+    struct dirent * dirent;
+    struct stat dir_stat, entry_stat;
+    struct roms_dir roms_dir;
+    struct roms_walk_queue * queue;
+
+
+    queue = walker->queue;
+
+    memset(&roms_dir, 0, sizeof(roms_dir));
+    roms_dir.path = (char *) path;
+
+    //watch before reading the folder, so no change falls between them
+    _get_dir_path(dir_path, path);
+    roms_dir.wd = (_roms_watch_fd == -1) ? -1
+                  : inotify_add_watch(_roms_watch_fd, dir_path,
+                                      ROMS_WATCH_MASK);
+
+    //take the timestamps before reading any entry
+    fd = openat(queue->root_fd, (path[0] == '\0') ? "." : path,
+                O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) goto _walk_dir_fail;
+
+    ret = fstat(fd, &dir_stat);
+    dir = (ret == 0) ? fdopendir(fd) : NULL;
+    if (dir == NULL) {
+        close(fd);
+        goto _walk_dir_fail;
+    }
+
+    _set_scan(&roms_dir.scan, &dir_stat);
+    ret = _apd_dir(&walker->dirs, &roms_dir);
+    if (ret != 0) {
+        closedir(dir);
+        _stop_walk(queue, true);
+        return;
+    }
+
+    //for all folder entries, until the walk is stopped
+    while ((dirent = readdir(dir)) != NULL
+           && atomic_load(&queue->is_stopped) == false) {
+
+        //filesystems that don't report types are asked
+        type = dirent->d_type;
+        if (type == DT_UNKNOWN) {
+            ret = fstatat(fd, dirent->d_name, &entry_stat,
+                          AT_SYMLINK_NOFOLLOW);
+            if (ret == 0) type = IFTODT(entry_stat.st_mode);
+        }
+
+        //queue subfolders, skipping hidden ones, "." & ".." & those read
+        //apart from this folder
+        if (type == DT_DIR) {
+
+            if (dirent->d_name[0] == '.') continue;
+            if (_join_path(entry_path, path, dirent->d_name) == false)
+                continue;
+
+            if (queue->known != NULL
+                && _has_path(queue->known, entry_path, strlen(entry_path)))
+                continue;
+
+            _queue_dir(queue, entry_path);
+            continue;
+        }
+
+        //skip entries that aren't ROMs
+        if (_is_rom(fd, dirent->d_name, type) == false) continue;
+        if (_join_path(entry_path, path, dirent->d_name) == false) continue;
+
+        //add this path to the thread's vector
+        rom_path = _dup_path(entry_path);
+        ret = (rom_path == NULL) ? -1 : cm_vct_apd(&walker->paths, &rom_path);
+        if (ret != 0) {
+            free(rom_path);
+            _stop_walk(queue, true);
+            break;
+        }
+        atomic_fetch_add(&_scan_found, 1);
+    }
+
+    closedir(dir);
+    return;
+
+    //a subfolder that can't be read is left out, the top one fails the walk
+    _walk_dir_fail:
+    if (roms_dir.wd != -1) inotify_rm_watch(_roms_watch_fd, roms_dir.wd);
+    if (path[0] == '\0') _stop_walk(queue, true);
+    return;
+}
+
+
+//walk thread: read queued folders until none are left
+static void * _walker_main(void * arg) {
+
+    char * path;
+    struct roms_walker * walker;
+    struct roms_walk_queue * queue;
+
+
+    walker = arg;
+    queue  = walker->queue;
+
+    for (;;) {
+
+        //wait for a folder while others may still queue some
+        pthread_mutex_lock(&queue->lock);
+        while (queue->dirs.len == 0 && queue->busy > 0
+               && atomic_load(&queue->is_stopped) == false)
+            pthread_cond_wait(&queue->cond, &queue->lock);
+
+        //the walk is done, wake the others to see it too
+        if (queue->dirs.len == 0
+            || atomic_load(&queue->is_stopped) == true) {
+            pthread_cond_broadcast(&queue->cond);
+            pthread_mutex_unlock(&queue->lock);
+            break;
+        }
+
+        path = _get_path(&queue->dirs, queue->dirs.len - 1);
+        cm_vct_rmv(&queue->dirs, queue->dirs.len - 1);
+        queue->busy += 1;
+        pthread_mutex_unlock(&queue->lock);
+
+        _walk_dir(walker, path);
+        free(path);
+
+        pthread_mutex_lock(&queue->lock);
+        queue->busy -= 1;
+        if (queue->busy == 0) pthread_cond_broadcast(&queue->cond);
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    return NULL;
+}
+
+
+//get the number of threads reading folders, a core is left to the menu
+static int _get_walker_num() {
+
+    long cpus;
+
+
+    cpus = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    if (cpus < 1) return 1;
+
+    return (cpus > ROMS_WALK_THREADS_MAX) ? ROMS_WALK_THREADS_MAX : cpus;
+}
+
+
+//scanner thread: move the walkers' findings into a walk, sorted
+static bool _merge_walkers(struct roms_walk * walk,
+                           struct roms_walker * walkers, int walker_num) {
+
+    int ret, last;
+    struct roms_walker * walker;
+
+
+    //the paths move, the walkers are left holding those that didn't
+    for (int i = 0; i < walker_num; ++i) {
+
+        walker = &walkers[i];
+        while ((last = walker->dirs.len - 1) >= 0) {
+            ret = cm_vct_apd(&walk->dirs, cm_vct_get_p(&walker->dirs, last));
+            if (ret != 0) return false;
+            cm_vct_rmv(&walker->dirs, last);
+        }
+
+        while ((last = walker->paths.len - 1) >= 0) {
+            ret = cm_vct_apd(&walk->paths, cm_vct_get_p(&walker->paths, last));
+            if (ret != 0) return false;
+            cm_vct_rmv(&walker->paths, last);
+        }
+    }
+
+    if (walk->dirs.len > 0)
+        qsort(cm_vct_get_p(&walk->dirs, 0), walk->dirs.len,
+              sizeof(struct roms_dir), _cmp_dir);
+    if (walk->paths.len > 0)
+        qsort(cm_vct_get_p(&walk->paths, 0), walk->paths.len,
+              sizeof(char *), _cmp_path);
+
+    return true;
+}
+
+
+/*
+ *  NOTE: A walk spreads the tree's folders over a walker thread per
+ *        core but one, up to ROMS_WALK_THREADS_MAX. Each thread takes a
+ *        folder off a shared queue, queues its subfolders & keeps the
+ *        ROMs it finds to itself; they are merged & sorted once every
+ *        thread is done. The scanner thread waits for them, reporting
+ *        progress & stopping them if the walk is superseded.
+ */
+
+//scanner thread: walk the folders of `seeds` & the new subfolders below
+//them, false if the walk was superseded; `seeds` is released
+static bool _walk_roms(struct roms_walk * walk, cm_vct * seeds,
+                       cm_vct * known) {
+
+    int ret, walker_num;
+    bool is_current;
+    uint64_t report_ms;
+
+    pthread_condattr_t cond_attr;
+    struct timespec deadline;
+    struct roms_walk_queue queue;
+    struct roms_walker walkers[ROMS_WALK_THREADS_MAX];
+
+
+    walk->is_good = false;
+
+    queue.root_fd = open(PATH_ROMS, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (queue.root_fd == -1) {
+        _del_paths(seeds);
+        return true;
+    }
+
+    //setup the queue with the folders to read
+    pthread_mutex_init(&queue.lock, NULL);
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&queue.cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+
+    queue.busy      = 0;
+    queue.is_failed = false;
+    queue.dirs      = *seeds;
+    queue.known     = known;
+    atomic_init(&queue.is_stopped, false);
+
+    //start the walkers, fewer if some can't be started
+    walker_num = _get_walker_num();
+    for (int i = 0; i < walker_num; ++i) {
+
+        walkers[i].queue = &queue;
+        ret = cm_new_vct(&walkers[i].dirs, sizeof(struct roms_dir));
+        ret |= cm_new_vct(&walkers[i].paths, sizeof(char *));
+        if (ret != 0) FATAL_FAIL("Failed to initialise the ROM walk vector.");
+
+        //signals stay blocked in the walkers, they are read by the menu
+        ret = pthread_create(&walkers[i].thread, NULL, _walker_main,
+                             &walkers[i]);
+        if (ret != 0) {
+            _del_dirs(&walkers[i].dirs);
+            _del_paths(&walkers[i].paths);
+            walker_num = i;
+            break;
+        }
+    }
+    if (walker_num == 0) queue.is_failed = true;
+
+    //wait for the walkers, reporting progress to the menu
+    is_current = true;
+    report_ms  = mono_ms();
+    pthread_mutex_lock(&queue.lock);
+    while (walker_num > 0 && (queue.dirs.len > 0 || queue.busy > 0)
+           && atomic_load(&queue.is_stopped) == false) {
+
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += ROMS_PROGRESS_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec  += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&queue.cond, &queue.lock, &deadline);
+
+        //give up if stopped or a newer walk was requested
+        is_current = atomic_load(&_scan_req_gen) == walk->gen
+                     && atomic_load(&_scan_is_stopped) == false;
+        if (is_current == false) {
+            atomic_store(&queue.is_stopped, true);
+            pthread_cond_broadcast(&queue.cond);
+            break;
+        }
+
+        if (mono_ms() - report_ms >= ROMS_PROGRESS_MS) {
+            ev_notify(_scan_ready_fd);
+            report_ms = mono_ms();
+        }
+    }
+    pthread_mutex_unlock(&queue.lock);
+
+    for (int i = 0; i < walker_num; ++i)
+        pthread_join(walkers[i].thread, NULL);
+
+    //only a walk that read the whole tree is good
+    if (is_current == true && queue.is_failed == false)
+        walk->is_good = _merge_walkers(walk, walkers, walker_num);
+
+    for (int i = 0; i < walker_num; ++i) {
+        _del_dirs(&walkers[i].dirs);
+        _del_paths(&walkers[i].paths);
+    }
+
+    _del_paths(&queue.dirs);
+    pthread_cond_destroy(&queue.cond);
+    pthread_mutex_destroy(&queue.lock);
+    close(queue.root_fd);
+
+    return is_current;
+}
+
+
+//scanner thread: watch the folders last read, keeping those unchanged in
+//`walk`; those that changed are read again from `seeds` & with those gone
+//are `stale`, those still present are `known`; false to walk the tree
+static bool _check_roms(struct roms_walk * walk, cm_vct * seeds,
+                        cm_vct * known) {
+
+    int ret;
+    bool is_present;
+    char dir_path[PATH_MAX];
+
+    struct stat dir_stat;
+    struct roms_dir roms_dir;
+
+
+    if (_scan_dirs.len == 0) return false;
+
+    //watch before checking the folder, so no change falls between them
+    for (int i = 0; i < _scan_dirs.len; ++i) {
+
+        roms_dir = *(struct roms_dir *) cm_vct_get_p(&_scan_dirs, i);
+
+        _get_dir_path(dir_path, roms_dir.path);
+        roms_dir.wd = (_roms_watch_fd == -1) ? -1
+                      : inotify_add_watch(_roms_watch_fd, dir_path,
+                                          ROMS_WATCH_MASK);
+
+        //the ROMs directory itself sorts first, without it there's no tree
+        is_present = (stat(dir_path, &dir_stat) == 0);
+        if (is_present == false && i == 0) return false;
+
+        //a changed folder is read again, one that's gone loses its ROMs
+        if (is_present == true
+            && _is_scan_current(&roms_dir.scan, &dir_stat) == true) {
+            ret = _apd_dir(&walk->dirs, &roms_dir);
+        } else {
+            ret = _apd_path(&walk->stale, roms_dir.path);
+            if (ret == 0 && is_present == true)
+                ret = _apd_path(seeds, roms_dir.path);
+        }
+
+        //the walk reads every folder present once, from its own entry
+        if (ret == 0 && is_present == true)
+            ret = cm_vct_apd(known, &roms_dir.path);
+        if (ret != 0) return false;
+    }
+
+    return true;
+}
+
+
+//scanner thread: check or walk the tree & hand the result to the menu
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_scan_walk(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    int ret;
+    bool is_current, need_walk;
+    cm_vct seeds, known;
+    struct roms_walk walk;
+
+
+    ev_read_notify(fd);
+    if (atomic_load(&_scan_is_stopped) == true) return;
+
+    walk.gen  = atomic_load(&_scan_req_gen);
+    need_walk = atomic_exchange(&_scan_need_walk, false);
+
+    ret = cm_new_vct(&walk.dirs, sizeof(struct roms_dir));
+    ret |= cm_new_vct(&walk.paths, sizeof(char *));
+    ret |= cm_new_vct(&walk.stale, sizeof(char *));
+    ret |= cm_new_vct(&seeds, sizeof(char *));
+    ret |= cm_new_vct(&known, sizeof(char *)); //points into `_scan_dirs`
+    if (ret != 0) FATAL_FAIL("Failed to initialise the ROM walk vector.");
+
+    //read only the folders that changed, or the whole tree from the top
+    walk.is_good    = true;
+    walk.is_partial = (need_walk == false
+                       && _check_roms(&walk, &seeds, &known) == true);
+    if (walk.is_partial == false) {
+
+        _empty_dirs(&walk.dirs);
+        _empty_paths(&walk.stale);
+        _empty_paths(&seeds);
+        ret = _apd_path(&seeds, "");
+        if (ret != 0) FATAL_FAIL("Failed to initialise the ROM walk vector.");
+    }
+
+    //an unchanged tree only needs watching again
+    walk.is_current = (walk.is_partial == true && walk.stale.len == 0);
+    if (walk.is_current == true) _del_paths(&seeds);
+
+    //a superseded walk is dropped, the newer request is pending & walks too
+    if (walk.is_current == false) {
+
+        is_current = _walk_roms(&walk, &seeds,
+                                (walk.is_partial == true) ? &known : NULL);
+        if (is_current == false) {
+            if (need_walk == true) atomic_store(&_scan_need_walk, true);
+            cm_del_vct(&known);
+            _del_walk(&walk);
+            return;
+        }
+
+        //the next check is against this walk
+        _empty_dirs(&_scan_dirs);
+        for (int i = 0; walk.is_good == true && i < walk.dirs.len; ++i) {
+            ret = _apd_dir(&_scan_dirs, cm_vct_get_p(&walk.dirs, i));
+            if (ret != 0) {
+                _empty_dirs(&_scan_dirs);
+                break;
+            }
+        }
+    }
+    cm_del_vct(&known);
+
+    //replace a result the menu hasn't taken yet
+    pthread_mutex_lock(&_scan_lock);
+    if (_scan_has_result == true) _del_walk(&_scan_result);
+    _scan_result     = walk;
+    _scan_has_result = true;
+    pthread_mutex_unlock(&_scan_lock);
+
+    ev_notify(_scan_ready_fd);
+
+    return;
+}
+
+
+/*
+ *  NOTE: The index records each folder as read when it's written, so the
+ *        next boot only reads the folders changed since. The folders are
+ *        stamped first, on the scanner thread when it runs, then the
+ *        events queued by then are applied, so no change made before a
+ *        stamp is missing from the list written with it.
+ */
+
+//record the folders of `dirs` as read now
+static void _stamp_dirs(cm_vct * dirs) {
+
+    int ret;
+    char dir_path[PATH_MAX];
+
+    struct stat dir_stat;
+    struct roms_dir * roms_dir;
+
+
+    for (int i = 0; i < dirs->len; ++i) {
+
+        roms_dir = cm_vct_get_p(dirs, i);
+        _get_dir_path(dir_path, roms_dir->path);
+
+        ret = stat(dir_path, &dir_stat);
+        if (ret == 0) _set_scan(&roms_dir->scan, &dir_stat);
+        else roms_dir->scan.is_valid = false;
+    }
+
+    return;
+}
+
+
+//scanner thread: stamp the folders last read & hand them to the menu
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_scan_stamp(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    int ret;
+    cm_vct stamps;
+
+
+    ev_read_notify(fd);
+
+    ret = cm_new_vct(&stamps, sizeof(struct roms_dir));
+    if (ret != 0) FATAL_FAIL("Failed to initialise the ROM walk vector.");
+
+    //folders left out keep the stamps of their last read
+    for (int i = 0; i < _scan_dirs.len; ++i) {
+        ret = _apd_dir(&stamps, cm_vct_get_p(&_scan_dirs, i));
+        if (ret != 0) break;
+    }
+    _stamp_dirs(&stamps);
+
+    //replace stamps the menu hasn't taken yet
+    pthread_mutex_lock(&_scan_lock);
+    if (_scan_has_stamps == true) _del_dirs(&_scan_stamps);
+    _scan_stamps     = stamps;
+    _scan_has_stamps = true;
+    pthread_mutex_unlock(&_scan_lock);
+
+    ev_notify(_scan_ready_fd);
+
+    return;
+}
+
+
+//write an index, replacing the old one atomically
+static void _write_index(const struct roms_idx_job * job) {
+
+    int ret;
+    size_t count, rec_count;
+    FILE * file;
+
+
+    //a failed write only costs a walk on the next boot
+    file = fopen(PATH_ROMS_IDX ".tmp", "wb");
+    if (file == NULL) return;
+
+    count = fwrite(&job->hdr, sizeof(job->hdr), 1, file);
+    if (count != 1) goto _write_index_cleanup;
+
+    rec_count = (size_t) job->hdr.dir_count * job->hdr.dir_sz
+                + job->hdr.str_sz;
+    count = fwrite(job->recs, 1, rec_count, file);
+    if (count != rec_count) goto _write_index_cleanup;
+
+    ret = fclose(file);
+    if (ret != 0) goto _write_index_unlink;
+    rename(PATH_ROMS_IDX ".tmp", PATH_ROMS_IDX);
+    return;
+
+    _write_index_cleanup:
+    fclose(file);
+
+    _write_index_unlink:
+    unlink(PATH_ROMS_IDX ".tmp");
+    return;
+}
+
+
+//scanner thread: write the index handed over by the menu
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_scan_write(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    bool has_job;
+    struct roms_idx_job job;
+
+
+    ev_read_notify(fd);
+
+    pthread_mutex_lock(&_scan_lock);
+    job           = _scan_job;
+    has_job       = _scan_has_job;
+    _scan_has_job = false;
+    pthread_mutex_unlock(&_scan_lock);
+
+    if (has_job == false) return;
+    _write_index(&job);
+    free(job.recs);
+
+    return;
+}
+
+
+//stop the scanner thread
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_scan_stop(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    ev_read_notify(fd);
+    ev_stop(&_scan_loop);
+
+    return;
+}
+
+
+//scanner thread: walk & write on request until stopped
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void * _scan_thread_main(void * arg) {
+#pragma GCC diagnostic pop
+
+    //walkers started from here inherit the niceness
+    setpriority(PRIO_PROCESS, 0, ROMS_WALK_NICE);
+
+    ev_run(&_scan_loop);
+    return NULL;
+}
+
+
+//check if a walk was requested that the list doesn't reflect yet
+static bool _is_walking() {
+
+    return atomic_load(&_scan_req_gen) != _scan_done_gen;
+}
+
+
+/*
+ *  NOTE: A walk isn't restarted by changes made while it runs, or a busy
+ *        tree would never be walked to the end. Checks & walks requested
+ *        meanwhile are sent once its result is applied, & the events
+ *        read meanwhile are held & applied to its result.
+ */
+
+//request a check of the folders last read, reading those that changed
+static void _request_check() {
+
+    _roms_want_check = true;
+    return;
+}
+
+
+//request a walk of the ROMs directory
+static void _request_walk() {
+
+    _roms_want_walk = true;
+    return;
+}
+
+
+//send the check or walk requested to the scanner thread, unless a walk is
+//in progress or the thread is stopped
+static void _send_request() {
+
+    if (_roms_want_check == false && _roms_want_walk == false) return;
+    if (_is_walking() == true || atomic_load(&_scan_is_stopped) == true)
+        return;
+
+    if (_roms_want_walk == true) atomic_store(&_scan_need_walk, true);
+    _roms_want_check = false;
+    _roms_want_walk  = false;
+
+    atomic_fetch_add(&_scan_req_gen, 1);
+    atomic_store(&_scan_found, 0);
+    ev_notify(_scan_walk_fd);
+
+    return;
+}
+
+
+//write the index once changes settle
+static void _queue_save() {
+
+    _roms_idx_is_stale = true;
+    ev_set_timer(_roms_save_fd, ROMS_IDX_SAVE_MS, 0);
+
+    return;
+}
+
+
+//publish a changed ROM list
+static void _on_roms_changed() {
+
+    _reset_items();
+    _publish_count();
+    _roms_change_cb(true);
+
+    return;
+}
+
+
+//empty the ROM list after the ROMs directory can't be read
+static void _lose_roms() {
+
+    _empty_paths(&rom_basenames);
+    _empty_dirs(&_roms_dirs);
+    subsys_state.rom_good = false;
+    _roms_is_watched      = false;
+
+    return;
+}
+
+
+//find the folder of an inotify watch, NULL if it isn't known
+static struct roms_dir * _find_watch_dir(int wd) {
+
+    struct roms_dir * roms_dir;
+
+
+    for (int i = 0; i < _roms_dirs.len; ++i) {
+        roms_dir = cm_vct_get_p(&_roms_dirs, i);
+        if (roms_dir->wd == wd) return roms_dir;
+    }
+
+    return NULL;
+}
+
+
+//look up the dirent type of an entry of a watched folder & whether it's
+//a ROM the way the walker would, DT_UNKNOWN if it's gone
+static unsigned char _lookup_watched(const struct roms_dir * roms_dir,
+                                     const char * name, bool * is_rom) {
+
+    int ret, dir_fd;
+    unsigned char type;
+    struct stat entry_stat;
+    char dir_path[PATH_MAX];
+
+
+    *is_rom = false;
+
+    _get_dir_path(dir_path, roms_dir->path);
+    dir_fd = open(dir_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd == -1) return DT_UNKNOWN;
+
+    ret = fstatat(dir_fd, name, &entry_stat, AT_SYMLINK_NOFOLLOW);
+    type = (ret == 0) ? IFTODT(entry_stat.st_mode) : DT_UNKNOWN;
+    if (ret == 0) *is_rom = _is_rom(dir_fd, name, type);
+
+    close(dir_fd);
+    return type;
+}
+
+
+//apply a single event to the ROMs vector, return true if it changed
+static bool _apply_roms_event(const struct inotify_event * event) {
+
+    int ret, idx;
+    bool is_rom;
+    unsigned char type;
+    char path[ROMS_PATH_MAX], * rom_path;
+    struct roms_dir * roms_dir;
+
+
+    //events were lost, walk again
+    if (event->mask & IN_Q_OVERFLOW) {
+        _request_walk();
+        return false;
+    }
+
+    //a watch is only known once the walk that added it is applied
+    roms_dir = _find_watch_dir(event->wd);
+    if (roms_dir == NULL) {
+        if ((event->mask & IN_IGNORED) == 0) _request_walk();
+        return false;
+    }
+
+    //the ROMs directory is gone, fall back to walking on demand
+    if (roms_dir->path[0] == '\0'
+        && (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))) {
+        _lose_roms();
+        return true;
+    }
+
+    //a subfolder going away is reported by its parent as well
+    if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        if (event->mask & IN_IGNORED) roms_dir->wd = -1;
+        return false;
+    }
+
+    if (event->len == 0) return false;
+
+    //a folder appearing or going away changes a whole subtree, check the
+    //folders again
+    if (event->mask & IN_ISDIR) {
+        if (event->name[0] != '.') _request_check();
+        return false;
+    }
+
+    if (_join_path(path, roms_dir->path, event->name) == false) return false;
+    idx = find_rom(path);
+
+    //the entry is gone
+    if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+
+        if (idx == -1) return false;
+        _free_path(_get_path(&rom_basenames, idx));
+        cm_vct_rmv(&rom_basenames, idx);
+        return true;
+    }
+
+    //a written entry is a regular file, the type of one created or moved
+    //in is looked up; a created file is still being written & is added
+    //once it's closed, but links are never written
+    if (_is_rom(-1, event->name, DT_REG) == false) {
+        is_rom = false;
+    } else if (event->mask & IN_CLOSE_WRITE) {
+        is_rom = true;
+    } else {
+        type = _lookup_watched(roms_dir, event->name, &is_rom);
+        if ((event->mask & IN_CREATE) && type != DT_LNK) return false;
+    }
+
+    if (is_rom == false) {
+
+        if (idx == -1) return false;
+        _free_path(_get_path(&rom_basenames, idx));
+        cm_vct_rmv(&rom_basenames, idx);
+        return true;
+    }
+    if (idx != -1) return false;
+
+    //keep the vector sorted
+    idx = _bound_rom(path);
+    rom_path = _dup_path(path);
+    if (rom_path == NULL) {
+        ret = -1;
+    } else {
+        ret = (idx == rom_basenames.len)
+              ? cm_vct_apd(&rom_basenames, &rom_path)
+              : cm_vct_ins(&rom_basenames, idx, &rom_path);
+    }
+    if (ret != 0) {
+        free(rom_path);
+        subsys_state.rom_good = false;
+        _reset_roms();
+    }
+
+    return true;
+}
+
+
+//hold an event read during a walk
+static void _hold_roms_event(const struct inotify_event * event) {
+
+    size_t sz;
+
+
+    //the name is padded, so held events stay aligned
+    sz = sizeof(struct inotify_event) + event->len;
+    if (_roms_pending_len + sz > ROMS_PENDING_SZ) {
+        _roms_pending_lost = true;
+        return;
+    }
+
+    memcpy(_roms_pending + _roms_pending_len, event, sz);
+    _roms_pending_len += sz;
+
+    return;
+}
+
+
+//apply the events held during a walk, return true if any were held
+static bool _apply_held_events(bool * is_changed) {
+
+    bool is_held;
+    const struct inotify_event * event;
+
+
+    is_held = (_roms_pending_len > 0 || _roms_pending_lost == true);
+
+    for (char * ptr = _roms_pending; ptr < _roms_pending + _roms_pending_len;
+         ptr += sizeof(struct inotify_event) + event->len) {
+
+        event = (const struct inotify_event *) ptr;
+        if (_apply_roms_event(event) == true) *is_changed = true;
+    }
+
+    //events were lost, walk again
+    if (_roms_pending_lost == true) _request_walk();
+
+    _roms_pending_len  = 0;
+    _roms_pending_lost = false;
+
+    return is_held;
+}
+
+
+//drop the events held during a walk
+static void _drop_held_events() {
+
+    _roms_pending_len  = 0;
+    _roms_pending_lost = false;
+
+    return;
+}
+
+
+//apply queued ROMs directory events, return true if any were read
+static bool _read_roms_events(bool * is_changed) {
+
+    ssize_t len;
+    bool is_read;
+    const struct inotify_event * event;
+
+    _Alignas(struct inotify_event) char buf[ROMS_EVENT_BUF_SZ];
+
+
+    //apply every queued event
+    is_read = false;
+    while (_roms_watch_fd != -1
+           && (len = read(_roms_watch_fd, buf, ROMS_EVENT_BUF_SZ)) > 0) {
+
+        is_read = true;
+        for (char * ptr = buf; ptr < buf + len;
+             ptr += sizeof(struct inotify_event) + event->len) {
+
+            //entries a walk already passed may have changed, they're
+            //applied to its result
+            event = (const struct inotify_event *) ptr;
+            if (_is_walking() == true) _hold_roms_event(event);
+            else if (_apply_roms_event(event) == true) *is_changed = true;
+        }
+    }
+
+    return is_read;
+}
+
+
+//apply queued ROMs directory events
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_roms_event(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    bool is_read, is_changed;
+
+
+    is_changed = false;
+    is_read = _read_roms_events(&is_changed);
+
+    //the index is out of date even if no ROM changed
+    if (is_read == true) _queue_save();
+    if (is_changed == true) _on_roms_changed();
+    _send_request();
+
+    return;
+}
+
+
+//take the stamps of the folders still listed, both are sorted by path
+static void _take_stamps(cm_vct * stamps) {
+
+    int cmp, stamp_idx;
+    struct roms_dir * roms_dir, * stamp;
+
+
+    stamp_idx = 0;
+    for (int i = 0; i < _roms_dirs.len && stamp_idx < stamps->len; ++i) {
+
+        roms_dir = cm_vct_get_p(&_roms_dirs, i);
+
+        //skip the stamps of folders that went away
+        cmp = -1;
+        while (stamp_idx < stamps->len) {
+            stamp = cm_vct_get_p(stamps, stamp_idx);
+            cmp = strcmp(stamp->path, roms_dir->path);
+            if (cmp >= 0) break;
+            stamp_idx += 1;
+        }
+
+        if (cmp == 0) roms_dir->scan = stamp->scan;
+    }
+
+    return;
+}
+
+
+//hand the ROM list to the scanner thread to be written as the index, its
+//folders are stamped
+static void _save_index(bool * is_changed) {
+
+    size_t dirs_sz, str_sz, len;
+    char * path, * rec;
+    struct roms_dir * roms_dir;
+    struct roms_idx_job job;
+
+
+    //a walk queues the write once it's applied
+    if (_is_walking() == true) return;
+
+    //while watched, every change made before the stamps is queued by now
+    if (_roms_is_watched == true) {
+
+        _read_roms_events(is_changed);
+        _send_request();
+        if (_is_walking() == true) return;
+    }
+
+    //copy the lists, they keep changing while the thread writes
+    dirs_sz = (size_t) _roms_dirs.len * sizeof(struct roms_scan);
+    str_sz  = 0;
+    for (int i = 0; i < _roms_dirs.len; ++i)
+        str_sz += strlen(((struct roms_dir *)
+                          cm_vct_get_p(&_roms_dirs, i))->path) + 1;
+    for (int i = 0; i < rom_basenames.len; ++i)
+        str_sz += strlen(_get_path(&rom_basenames, i)) + 1;
+
+    job.recs = malloc(dirs_sz + str_sz + 1);
+    if (job.recs == NULL) return;
+
+    rec = job.recs;
+    for (int i = 0; i < _roms_dirs.len; ++i) {
+        roms_dir = cm_vct_get_p(&_roms_dirs, i);
+        memcpy(rec, &roms_dir->scan, sizeof(roms_dir->scan));
+        rec += sizeof(roms_dir->scan);
+    }
+
+    for (int i = 0; i < _roms_dirs.len; ++i) {
+        path = ((struct roms_dir *) cm_vct_get_p(&_roms_dirs, i))->path;
+        len  = strlen(path) + 1;
+        memcpy(rec, path, len);
+        rec += len;
+    }
+
+    for (int i = 0; i < rom_basenames.len; ++i) {
+        path = _get_path(&rom_basenames, i);
+        len  = strlen(path) + 1;
+        memcpy(rec, path, len);
+        rec += len;
+    }
+
+    memset(&job.hdr, 0, sizeof(job.hdr));
+    job.hdr.magic     = ROMS_IDX_MAGIC;
+    job.hdr.version   = ROMS_IDX_VERSION;
+    job.hdr.exts_hash = _hash_exts();
+    job.hdr.dir_sz    = sizeof(struct roms_scan);
+    job.hdr.dir_count = _roms_dirs.len;
+    job.hdr.count     = rom_basenames.len;
+    job.hdr.str_sz    = str_sz;
+
+    //replace an index the thread hasn't written yet
+    pthread_mutex_lock(&_scan_lock);
+    if (_scan_has_job == true) free(_scan_job.recs);
+    _scan_job     = job;
+    _scan_has_job = true;
+    pthread_mutex_unlock(&_scan_lock);
+
+    _roms_idx_is_stale = false;
+
+    return;
+}
+
+
+//merge the ROMs of the folders a partial walk read into the list, return
+//true if the list changed
+static bool _merge_walk(struct roms_walk * walk) {
+
+    int ret, cmp, old_idx, walk_idx;
+    bool is_changed;
+    char * old_path, * walk_path;
+    cm_vct merged;
+
+
+    ret = cm_new_vct(&merged, sizeof(char *));
+    if (ret != 0) FATAL_FAIL("Failed to initialise the ROM vector.");
+
+    //merge the sorted lists, the paths are borrowed until it's done
+    is_changed = false;
+    old_idx = walk_idx = 0;
+    while (ret == 0
+           && (old_idx < rom_basenames.len || walk_idx < walk->paths.len)) {
+
+        old_path  = (old_idx < rom_basenames.len)
+                    ? _get_path(&rom_basenames, old_idx) : NULL;
+        walk_path = (walk_idx < walk->paths.len)
+                    ? _get_path(&walk->paths, walk_idx) : NULL;
+
+        cmp = (old_path == NULL) ? 1
+              : (walk_path == NULL) ? -1 : strcmp(old_path, walk_path);
+
+        //a ROM of a folder read again is listed only if it was found
+        if (cmp < 0) {
+            old_idx += 1;
+            if (_has_path(&walk->stale, old_path,
+                          _get_parent_len(old_path)) == true) {
+                is_changed = true;
+                continue;
+            }
+            ret = cm_vct_apd(&merged, &old_path);
+
+        //a ROM found again takes the place of its old path
+        } else {
+            if (cmp > 0) is_changed = true;
+            else old_idx += 1;
+            walk_idx += 1;
+            ret = cm_vct_apd(&merged, &walk_path);
+        }
+    }
+
+    //the list is left as it was, a walk makes it current
+    if (ret != 0) {
+        cm_del_vct(&merged);
+        _request_walk();
+        return false;
+    }
+
+    //release the old paths that weren't kept, the rest moved
+    for (int i = 0; i < rom_basenames.len; ++i) {
+
+        old_path = _get_path(&rom_basenames, i);
+        if (_has_path(&walk->stale, old_path, _get_parent_len(old_path))
+            || _has_path(&walk->paths, old_path, strlen(old_path)))
+            _free_path(old_path);
+    }
+
+    cm_del_vct(&rom_basenames);
+    rom_basenames = merged;
+    cm_vct_emp(&walk->paths);
+
+    return is_changed;
+}
+
+
+//replace the ROM list with a walk's, or its folders' ROMs with a partial's
+static void _apply_walk(struct roms_walk * walk) {
+
+    bool is_same, is_changed;
+    char * path, * walk_path;
+    cm_vct old_vct;
+    struct roms_dir * root_dir;
+
+
+    _scan_done_gen = walk->gen;
+
+    //the tree can't be read, the index is kept for when it can
+    if (walk->is_good == false) {
+
+        _del_walk(walk);
+        _drop_held_events();
+        _lose_roms();
+
+        _on_roms_changed();
+        _send_request();
+        return;
+    }
+
+    //swap the folders & their watches in
+    old_vct    = _roms_dirs;
+    _roms_dirs = walk->dirs;
+    _del_dirs(&old_vct);
+
+    //the ROMs directory itself sorts first, the list is back if it wasn't
+    root_dir = cm_vct_get_p(&_roms_dirs, 0);
+    _roms_is_watched = (root_dir != NULL && root_dir->wd != -1);
+    is_changed = (subsys_state.rom_good == false);
+    subsys_state.rom_good = true;
+
+    //an unchanged tree keeps its list & index, a partial walk replaces the
+    //ROMs of the folders it read
+    if (walk->is_current == false && walk->is_partial == true) {
+        if (_merge_walk(walk) == true) is_changed = true;
+
+    //compare the lists in order
+    } else if (walk->is_current == false) {
+
+        is_same = (rom_basenames.len == walk->paths.len);
+        for (int i = 0; is_same == true && i < rom_basenames.len; ++i) {
+
+            path      = _get_path(&rom_basenames, i);
+            walk_path = _get_path(&walk->paths, i);
+            is_same = (strcmp(path, walk_path) == 0);
+        }
+
+        //swap the walk in, the old list is released in its place
+        if (is_same == false) {
+            old_vct       = rom_basenames;
+            rom_basenames = walk->paths;
+            walk->paths   = old_vct;
+            is_changed    = true;
+        }
+    }
+    _del_paths(&walk->paths);
+    _del_paths(&walk->stale);
+
+    //changes made during the walk are applied to its result
+    if (_apply_held_events(&is_changed) == true) walk->is_current = false;
+
+    //the index is out of date even if no ROM changed
+    if (walk->is_current == false || _roms_idx_is_stale == true)
+        _queue_save();
+
+    //only the walk's progress goes away if no ROM changed
+    if (is_changed == true) _on_roms_changed();
+    else _roms_change_cb(false);
+    _send_request();
+
+    return;
+}
+
+
+//take a walk's result or progress from the scanner thread
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_scan_ready(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    bool has_result, has_stamps, is_changed;
+    cm_vct stamps;
+    struct roms_walk walk;
+
+
+    ev_read_notify(fd);
+
+    pthread_mutex_lock(&_scan_lock);
+    walk             = _scan_result;
+    has_result       = _scan_has_result;
+    stamps           = _scan_stamps;
+    has_stamps       = _scan_has_stamps;
+    _scan_has_result = false;
+    _scan_has_stamps = false;
+    pthread_mutex_unlock(&_scan_lock);
+
+    //apply a result unless a newer walk was requested since
+    if (has_result == true) {
+
+        if (walk.gen == atomic_load(&_scan_req_gen)) _apply_walk(&walk);
+        else _del_walk(&walk);
+    }
+
+    //write the index with the stamps, unless a walk will queue it again
+    if (has_stamps == true) {
+
+        if (_roms_idx_is_stale == true && _is_walking() == false) {
+
+            _take_stamps(&stamps);
+
+            is_changed = false;
+            _save_index(&is_changed);
+            ev_notify(_scan_write_fd);
+
+            if (is_changed == true) _on_roms_changed();
+        }
+        _del_dirs(&stamps);
+    }
+
+    //show the progress of the walk
+    if (has_result == false && has_stamps == false) _roms_change_cb(false);
+
+    return;
+}
+
+
+//take the next path of an index, NULL if it runs past `end` or is too long
+static const char * _next_idx_path(const char ** str, const char * end) {
+
+    const char * path, * term;
+
+
+    path = *str;
+    term = memchr(path, '\0', end - path);
+    if (term == NULL || term - path >= ROMS_PATH_MAX) return NULL;
+
+    *str = term + 1;
+    return path;
+}
+
+
+//map the index & list its paths in place, return false if it's missing or
+//invalid; the mapping is kept while the lists point into it
+static bool _load_index() {
+
+    int fd, ret;
+    bool is_loaded;
+    size_t sz;
+    void * map;
+    char * rom_path;
+
+    struct stat idx_stat;
+    struct roms_dir roms_dir;
+    const struct roms_idx_hdr * hdr;
+    const char * scan, * str, * end, * path, * prev_path;
+
+
+    fd = open(PATH_ROMS_IDX, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+
+    is_loaded = false;
+    ret = fstat(fd, &idx_stat);
+    sz = (size_t) idx_stat.st_size;
+    if (ret != 0 || sz < sizeof(*hdr)) goto _load_index_cleanup_fd;
+
+    map = mmap(NULL, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) goto _load_index_cleanup_fd;
+    madvise(map, sz, MADV_SEQUENTIAL);
+
+    _roms_idx_map = map;
+    _roms_idx_sz  = sz;
+
+    //an index of another format, other extensions or a truncated one
+    //is rewritten later
+    hdr = map;
+    if (hdr->magic != ROMS_IDX_MAGIC || hdr->version != ROMS_IDX_VERSION
+        || hdr->exts_hash != _hash_exts()
+        || hdr->dir_sz != sizeof(struct roms_scan)
+        || sz != sizeof(*hdr) + (size_t) hdr->dir_count * hdr->dir_sz
+                 + hdr->str_sz)
+        goto _load_index_cleanup_map;
+
+    scan = (const char *) (hdr + 1);
+    str  = scan + (size_t) hdr->dir_count * hdr->dir_sz;
+    end  = str + hdr->str_sz;
+
+    //add every folder, its watch belongs to the run that wrote it
+    prev_path = NULL;
+    for (uint32_t i = 0; i < hdr->dir_count; ++i, scan += hdr->dir_sz) {
+
+        path = _next_idx_path(&str, end);
+        if (path == NULL) break;
+        if (prev_path != NULL && strcmp(prev_path, path) >= 0) break;
+        prev_path = path;
+
+        roms_dir.path = (char *) path;
+        memcpy(&roms_dir.scan, scan, sizeof(roms_dir.scan));
+        roms_dir.wd = -1;
+
+        ret = cm_vct_apd(&_roms_dirs, &roms_dir);
+        if (ret != 0) break;
+    }
+
+    //add every path, they must be in order to be searched
+    prev_path = NULL;
+    for (uint32_t i = 0; (uint32_t) _roms_dirs.len == hdr->dir_count
+                         && i < hdr->count; ++i) {
+
+        path = _next_idx_path(&str, end);
+        if (path == NULL) break;
+        if (prev_path != NULL && strcmp(prev_path, path) >= 0) break;
+        prev_path = path;
+
+        rom_path = (char *) path;
+        ret = cm_vct_apd(&rom_basenames, &rom_path);
+        if (ret != 0) break;
+    }
+
+    //keep the lists only if every record was added
+    if ((uint32_t) _roms_dirs.len == hdr->dir_count
+        && (uint32_t) rom_basenames.len == hdr->count && str == end) {
+        is_loaded = true;
+        goto _load_index_cleanup_fd;
+    }
+    _empty_dirs(&_roms_dirs);
+    _empty_paths(&rom_basenames);
+
+    _load_index_cleanup_map:
+    munmap(map, sz);
+    _roms_idx_map = MAP_FAILED;
+
+    _load_index_cleanup_fd:
+    close(fd);
+
+    return is_loaded;
+}
+
+
+//write the index once changes settled
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_roms_save(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    bool is_changed;
+
+
+    ev_read_timer(fd);
+
+    //a walk queues the write once it's applied
+    if (_is_walking() == true) return;
+
+    //a watched tree is written once the scanner thread stamps its folders
+    if (_roms_is_watched == true) {
+        ev_notify(_scan_stamp_fd);
+        return;
+    }
+
+    is_changed = false;
+    _save_index(&is_changed);
+    ev_notify(_scan_write_fd);
+
+    if (is_changed == true) _on_roms_changed();
+
+    return;
+}
+
+
+//start the scanner thread, which reports to the menu's loop
+static void _init_scan() {
+
+    int ret;
+
+
+    atomic_init(&_scan_is_stopped, false);
+    atomic_init(&_scan_req_gen, 0);
+    atomic_init(&_scan_need_walk, false);
+    atomic_init(&_scan_found, 0);
+    _scan_done_gen   = 0;
+    _scan_has_result = false;
+    _scan_has_stamps = false;
+    _scan_has_job    = false;
+
+    //the thread checks the folders of the index first
+    ret = cm_new_vct(&_scan_dirs, sizeof(struct roms_dir));
+    if (ret != 0) FATAL_FAIL("Failed to initialise the ROM walk vector.");
+
+    for (int i = 0; i < _roms_dirs.len; ++i) {
+        ret = _apd_dir(&_scan_dirs, cm_vct_get_p(&_roms_dirs, i));
+        if (ret != 0) FATAL_FAIL("Failed to initialise the ROM walk vector.");
+    }
+
+    _scan_ready_fd = ev_add_notify(_roms_loop, _on_scan_ready, NULL);
+    if (_scan_ready_fd < 0)
+        FATAL_FAIL("Failed to create a notification source.")
+
+    //setup the scanner thread's sources
+    init_ev_loop(&_scan_loop);
+
+    _scan_stop_fd  = ev_add_notify(&_scan_loop, _on_scan_stop, NULL);
+    _scan_walk_fd  = ev_add_notify(&_scan_loop, _on_scan_walk, NULL);
+    _scan_stamp_fd = ev_add_notify(&_scan_loop, _on_scan_stamp, NULL);
+    _scan_write_fd = ev_add_notify(&_scan_loop, _on_scan_write, NULL);
+    if (_scan_stop_fd < 0 || _scan_walk_fd < 0 || _scan_stamp_fd < 0
+        || _scan_write_fd < 0)
+        FATAL_FAIL("Failed to create a notification source.")
+
+    //signals stay blocked in the scanner thread, they are read by the menu
+    ret = pthread_create(&_scan_thread, NULL, _scan_thread_main, NULL);
+    if (ret != 0) FATAL_FAIL("Failed to start the scanner thread.")
+
+    return;
+}
+
+
+//stop the scanner thread, it finishes a write in progress
+static void _fini_scan() {
+
+    atomic_store(&_scan_is_stopped, true);
+    ev_notify(_scan_stop_fd);
+    pthread_join(_scan_thread, NULL);
+
+    close(_scan_write_fd);
+    close(_scan_stamp_fd);
+    close(_scan_walk_fd);
+    close(_scan_stop_fd);
+    ev_del(_roms_loop, _scan_ready_fd);
+    close(_scan_ready_fd);
+    fini_ev_loop(&_scan_loop);
+
+    //release a result the menu didn't take
+    if (_scan_has_result == true) _del_walk(&_scan_result);
+    if (_scan_has_stamps == true) _del_dirs(&_scan_stamps);
+    _scan_has_result = false;
+    _scan_has_stamps = false;
+
+    _del_dirs(&_scan_dirs);
+
+    return;
+}
+
+
+//setup the inotify instance, the folders are watched as they're read
+static void _init_watch() {
+
+    int ret;
+
+
+    _roms_watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_roms_watch_fd == -1) return;
+
+    ret = ev_add(_roms_loop, _roms_watch_fd, EPOLLIN, _on_roms_event, NULL);
+    if (ret != 0) {
+        close(_roms_watch_fd);
+        _roms_watch_fd = -1;
+    }
+
+    return;
+}
+
+
+//release the inotify instance & every watch
+static void _fini_watch() {
+
+    if (_roms_watch_fd == -1) return;
+
+    ev_del(_roms_loop, _roms_watch_fd);
+    close(_roms_watch_fd);
+    _roms_watch_fd   = -1;
+    _roms_is_watched = false;
+
+    return;
+}
+
+
+//set the ROM extensions from a comma separated list, before initialising
+int set_rom_exts(const char * exts) {
+
+    int num, len;
+    const char * ext, * end;
+    char parsed[ROMS_EXT_MAX][ROMS_EXT_LEN];
+
+
+    //extensions are given without the dot
+    num = 0;
+    for (ext = exts; ; ext = end + 1) {
+
+        end = strchr(ext, ',');
+        if (end == NULL) end = ext + strlen(ext);
+
+        len = end - ext;
+        if (len == 0 || len >= ROMS_EXT_LEN || num == ROMS_EXT_MAX) return -1;
+
+        for (int i = 0; i < len; ++i)
+            parsed[num][i] = tolower((unsigned char) ext[i]);
+        parsed[num][len] = '\0';
+        num += 1;
+
+        if (*end == '\0') break;
+    }
+
+    memcpy(_roms_exts, parsed, sizeof(parsed));
+    _roms_ext_num = num;
+
+    return 0;
+}
+
+
+//initialise the global ROMs vector, kept current from the menu's `loop`
+void init_roms(struct ev_loop * loop, roms_change_cb change_cb) {
+
+    int ret;
+
+
+    _roms_loop      = loop;
+    _roms_change_cb = change_cb;
+    _roms_is_watched = false;
+    atomic_init(&_roms_count, -1);
+
+    if (_roms_ext_num == 0) set_rom_exts(ROMS_EXTS_DEFAULT);
+
+    ret = cm_new_vct(&rom_basenames, sizeof(char *));
+    ret |= cm_new_vct(&_roms_dirs, sizeof(struct roms_dir));
+    if (ret != 0) FATAL_FAIL("Failed to initialise the ROM vector.");
+
+    rom_folder[0]   = '\0';
+    _rom_folder_len = 0;
+
+    //the timer only runs while the index is out of date
+    _roms_save_fd = ev_add_timer(loop, 0, _on_roms_save, NULL);
+    if (_roms_save_fd < 0) FATAL_FAIL("Failed to create a timer source.")
+
+    _init_watch();
+
+    //start from the index, walk the tree if any of its folders changed
+    _roms_want_check   = false;
+    _roms_want_walk    = false;
+    _roms_pending_len  = 0;
+    _roms_pending_lost = false;
+
+    if (_load_index() == true) {
+        _init_scan();
+        _request_check();
+    } else {
+        _init_scan();
+        _request_walk();
+    }
+    _send_request();
+
+    _reset_items();
+    _publish_count();
+
+    return;
+}
+
+
+//release the global ROMs vector, writing the index if it's out of date
+void fini_roms() {
+
+    bool is_changed;
+
+
+    _fini_scan();
+
+    //write what the thread didn't, stamping the folders here
+    is_changed = false;
+    if (_roms_idx_is_stale == true) {
+        if (_roms_is_watched == true) _stamp_dirs(&_roms_dirs);
+        _save_index(&is_changed);
+    }
+    if (_scan_has_job == true) {
+        _write_index(&_scan_job);
+        free(_scan_job.recs);
+        _scan_has_job = false;
+    }
+
+    _fini_watch();
+
+    ev_del(_roms_loop, _roms_save_fd);
+    close(_roms_save_fd);
+
+    _del_dirs(&_roms_dirs);
+    _del_paths(&rom_basenames);
+
+    //no path points into the index anymore
+    if (_roms_idx_map != MAP_FAILED) munmap(_roms_idx_map, _roms_idx_sz);
+    _roms_idx_map = MAP_FAILED;
+
+    return;
+}
+
+
+//request a check of the tree if it isn't watched
+void update_roms() {
+
+    //a watched tree is always current, a walk makes it so
+    if (_roms_is_watched == true || _is_walking() == true) return;
+
+    //the scanner thread only reads the folders that changed, a list that
+    //was lost is walked whole
+    if (subsys_state.rom_good == false) _request_walk();
+    else _request_check();
+    _send_request();
+
+    return;
+}
+
+
+//count the ROMs, safe from any thread, -1 if they can't be read
+int count_roms() {
+
+    return atomic_load(&_roms_count);
+}
+
+
+//find a ROM by path, -1 if it isn't listed
+int find_rom(const char * path) {
+
+    int idx;
+    char * rom_path;
+
+
+    idx = _bound_rom(path);
+    if (idx == rom_basenames.len) return -1;
+
+    rom_path = _get_path(&rom_basenames, idx);
+    return (strcmp(rom_path, path) == 0) ? idx : -1;
+}
+
+
+//open a rom folder, "" is the top folder
+void open_rom_folder(const char * folder) {
+
+    memset(rom_folder, 0, ROMS_PATH_MAX);
+    strncpy(rom_folder, folder, ROMS_PATH_MAX - 1);
+    _rom_folder_len = strnlen(rom_folder, ROMS_PATH_MAX);
+
+    _reset_items();
+
+    return;
+}
+
+
+//count the items of the open folder
+int count_rom_items() {
+
+    _count_items();
+    return _rom_view.dir_num + _rom_view.file_num;
+}
+
+
+//get an item of the open folder, folders first, return 0 on success
+int get_rom_item(int item_idx, struct rom_item * item) {
+
+    int cur, idx, kind_first;
+    bool is_dir;
+
+
+    _count_items();
+    if (item_idx < 0 || item_idx >= _rom_view.dir_num + _rom_view.file_num)
+        return -1;
+
+    //step from the last item found if it's of the same kind & nearer
+    //than the first item of that kind
+    is_dir     = (item_idx < _rom_view.dir_num);
+    kind_first = (is_dir == true) ? 0 : _rom_view.dir_num;
+
+    cur = _rom_view.cur_item;
+    if (cur != -1 && (cur < _rom_view.dir_num) == is_dir
+        && abs(item_idx - cur) <= item_idx - kind_first) {
+        idx = _rom_view.cur_idx;
+    } else {
+        cur = kind_first;
+        idx = _seek_item(_rom_view.first, is_dir);
+    }
+
+    for (; cur < item_idx; ++cur)
+        idx = _seek_item(_next_item_idx(idx), is_dir);
+    for (; cur > item_idx; --cur)
+        idx = _seek_item_back(idx, is_dir);
+
+    _rom_view.cur_item = item_idx;
+    _rom_view.cur_idx  = idx;
+
+    item->is_dir  = is_dir;
+    item->rom_idx = idx;
+
+    return 0;
+}
+
+
+//get the name of an item of the open folder, folder names end in '/'
+const char * get_rom_item_name(const struct rom_item * item, int * len) {
+
+    char * name, * slash;
+
+
+    name = _get_path(&rom_basenames, item->rom_idx) + _rom_folder_len;
+
+    slash = (item->is_dir == true) ? strchr(name, '/') : NULL;
+    *len  = (slash != NULL) ? slash - name + 1 : (int) strlen(name);
+
+    return name;
+}
+
+
+//find an item of the open folder by name, -1 if it isn't listed
+int find_rom_item(const char * name) {
+
+    int len, item_idx;
+    const char * item_name;
+    struct rom_item item;
+
+
+    //folder names end in '/', only the items of one kind are compared
+    _count_items();
+    len = strlen(name);
+    item.is_dir = (len != 0 && name[len - 1] == '/');
+    item_idx    = (item.is_dir == true) ? 0 : _rom_view.dir_num;
+
+    item.rom_idx = _seek_item(_rom_view.first, item.is_dir);
+    while (item.rom_idx < _rom_view.end) {
+
+        item_name = get_rom_item_name(&item, &len);
+        if (strncmp(item_name, name, len) == 0 && name[len] == '\0') {
+            _rom_view.cur_item = item_idx;
+            _rom_view.cur_idx  = item.rom_idx;
+            return item_idx;
+        }
+
+        item.rom_idx = _seek_item(_next_item_idx(item.rom_idx), item.is_dir);
+        item_idx += 1;
+    }
+
+    return -1;
+}
+
+
+//get the ROMs found by a walk the list doesn't reflect yet, -1 if none
+int scan_progress_roms() {
+
+    if (_is_walking() == false) return -1;
+    return atomic_load(&_scan_found);
+}
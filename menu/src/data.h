@@ -1,28 +1,99 @@
 #ifndef DATA_H
 #define DATA_H
 
+//C standard library
+#include <stdbool.h>
+
+//kernel headers
+#include <linux/limits.h>
+
 //external libraries
 #include <cmore.h>
 
 //local headers
 #include "common.h"
+#include "event.h"
+
+
+// -- [macros] --
+
+//rom index file format
+#define ROMS_IDX_MAGIC   0x53505249 //"SPRI"
+#define ROMS_IDX_VERSION 3
+
+//rom extensions matched unless others are set
+#define ROMS_EXTS_DEFAULT "sfc,smc,fig,swc,zip,7z"
+
+//most rom extensions & the longest one, with its terminator
+#define ROMS_EXT_MAX 16
+#define ROMS_EXT_LEN 8
+
+//longest rom path relative to PATH_ROMS, with its terminator, that still
+//fits PATH_MAX once joined to PATH_ROMS
+#define ROMS_PATH_MAX ((int) (PATH_MAX - sizeof(PATH_ROMS)))
 
 
 // -- [data] --
 
-//rom storage
-extern cm_vct rom_basenames; //type: char[NAME_MAX]
+//rom storage, paths relative to PATH_ROMS in sorted order
+extern cm_vct rom_basenames; //type: char *
+
+
+//item of the open rom folder
+struct rom_item {
+
+    bool is_dir;
+    int rom_idx; //the rom, or the folder's first rom in `rom_basenames`
+};
+
+//open rom folder, "" or a path ending in '/'
+extern char rom_folder[ROMS_PATH_MAX];
+
+//bumped whenever the items of the open folder may have changed
+extern unsigned long rom_items_gen;
+
+
+//rom list change callback, `is_changed` is false if only the progress of
+//a walk changed
+typedef void (* roms_change_cb)(bool is_changed);
 
 
 // -- [text] --
 
-//initialise & release the global rom list
-void init_roms();
+//set the rom extensions from a comma separated list, before initialising
+int set_rom_exts(const char * exts);
+
+//initialise & release the global rom list, kept current from `loop`
+void init_roms(struct ev_loop * loop, roms_change_cb change_cb);
 void fini_roms();
 
-//repopulate the rom list
+//request a rom walk if the rom directory isn't watched & changed
 void update_roms();
 
+//count the roms, safe from any thread, -1 if they can't be read
+int count_roms();
+
+//find a rom by path, -1 if it isn't listed
+int find_rom(const char * path);
+
+//open a rom folder, "" is the top folder
+void open_rom_folder(const char * folder);
+
+//count the items of the open folder
+int count_rom_items();
+
+//get an item of the open folder, folders first, return 0 on success
+int get_rom_item(int item_idx, struct rom_item * item);
+
+//get the name of an item of the open folder, folder names end in '/'
+const char * get_rom_item_name(const struct rom_item * item, int * len);
+
+//find an item of the open folder by name, -1 if it isn't listed
+int find_rom_item(const char * name);
+
+//get the roms found by a walk the list doesn't reflect yet, -1 if none
+int scan_progress_roms();
+
 
 
 
@@ -0,0 +1,275 @@
+//C standard library
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+//system headers
+#include <unistd.h>
+
+//kernel headers
+#include <linux/input.h>
+#include <linux/input-event-codes.h>
+
+//external libraries
+#include <libevdev-1.0/libevdev/libevdev.h>
+#include <cmore.h>
+
+//local headers
+#include "common.h"
+#include "diag.h"
+#include "event.h"
+#include "input.h"
+#include "latency.h"
+
+
+/*
+ *  NOTE: Statistics are collected by the menu thread from the inputs
+ *        the device thread publishes, using their kernel timestamps.
+ *        The report rate counts SYN_REPORT frames. Jitter is the mean
+ *        difference between consecutive report intervals. The noise
+ *        floor is the largest axis change too small to be deliberate.
+ */
+
+// -- [globals] --
+
+//per-controller diagnostics
+static cm_vct _diag_js; //type: struct diag_js
+
+//collection state & the start of the current window
+static bool _diag_is_on;
+static uint64_t _diag_window_us;
+
+//window timer & the loop it's on
+static int _diag_timer_fd = -1;
+static struct ev_loop * _diag_loop;
+
+//menu's receiver of statistics changes
+static diag_change_cb _diag_change_cb;
+
+
+// -- [text] --
+
+//get a controller's diagnostics, growing the table as needed
+static struct diag_js * _get_diag_js(int idx) {
+
+    int ret;
+    struct diag_js new_diag;
+
+
+    memset(&new_diag, 0, sizeof(new_diag));
+    while (_diag_js.len <= idx) {
+        ret = cm_vct_apd(&_diag_js, &new_diag);
+        if (ret != 0) FATAL_FAIL("Failed to grow the diagnostics table.")
+    }
+
+    return cm_vct_get_p(&_diag_js, idx);
+}
+
+
+//find the menu key of an input, returns -1 if it isn't one
+static int _get_key_idx(int type, int code) {
+
+    for (int i = 0; i < KEY_OPT_NUM; ++i) {
+        if (js_key_codes[i].type == type && js_key_codes[i].code == code)
+            return i;
+    }
+
+    return -1;
+}
+
+
+//complete the current window of every controller
+static void _roll_diag(uint64_t now_us) {
+
+    uint64_t elapsed_us;
+    struct diag_js * diag;
+
+
+    elapsed_us = now_us - _diag_window_us;
+    if (elapsed_us == 0) return;
+    _diag_window_us = now_us;
+
+    for (int i = 0; i < _diag_js.len; ++i) {
+
+        diag = cm_vct_get_p(&_diag_js, i);
+
+        diag->rate_hz   = diag->reports * 1000000.0 / elapsed_us;
+        diag->jitter_ms = (diag->jitter_count == 0)
+                              ? 0 : diag->jitter_sum_us / 1000.0
+                                    / diag->jitter_count;
+        memcpy(diag->noise_floor, diag->noise, sizeof(diag->noise));
+
+        //start the next window
+        diag->reports       = 0;
+        diag->jitter_count  = 0;
+        diag->jitter_sum_us = 0;
+        memset(diag->noise, 0, sizeof(diag->noise));
+    }
+
+    return;
+}
+
+
+//complete a window & let the menu redraw
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_diag_timer(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    ev_read_timer(fd);
+    if (_diag_is_on == false) return;
+
+    _roll_diag(lat_now_us());
+    _diag_change_cb();
+
+    return;
+}
+
+
+//initialise diagnostics, windows are timed on `loop`
+void init_diag(struct ev_loop * loop, diag_change_cb change_cb) {
+
+    int ret;
+
+
+    _diag_is_on     = false;
+    _diag_change_cb = change_cb;
+    _diag_loop      = loop;
+
+    ret = cm_new_vct(&_diag_js, sizeof(struct diag_js));
+    if (ret != 0) FATAL_FAIL("Failed to initialise the diagnostics table.")
+
+    //the timer only runs while diagnostics are collected
+    _diag_timer_fd = ev_add_timer(loop, 0, _on_diag_timer, NULL);
+    if (_diag_timer_fd < 0) FATAL_FAIL("Failed to create a timer source.")
+
+    return;
+}
+
+
+//release diagnostics
+void fini_diag() {
+
+    ev_del(_diag_loop, _diag_timer_fd);
+    close(_diag_timer_fd);
+    _diag_timer_fd = -1;
+
+    cm_del_vct(&_diag_js);
+    return;
+}
+
+
+//start collecting diagnostics
+void diag_start() {
+
+    //every visit starts from fresh statistics
+    cm_vct_emp(&_diag_js);
+    _diag_window_us = lat_now_us();
+    _diag_is_on     = true;
+
+    ev_set_timer(_diag_timer_fd, DIAG_WINDOW_MS, DIAG_WINDOW_MS);
+    js_set_diag(true);
+
+    return;
+}
+
+
+//stop collecting diagnostics
+void diag_stop() {
+
+    _diag_is_on = false;
+
+    ev_set_timer(_diag_timer_fd, 0, 0);
+    js_set_diag(false);
+
+    return;
+}
+
+
+//account for a report frame
+static void _feed_report(struct diag_js * diag, uint64_t us) {
+
+    uint64_t interval_us, diff_us;
+
+
+    diag->reports += 1;
+
+    //a device without a monotonic clock may go backwards, skip it
+    if (diag->last_report_us != 0 && us >= diag->last_report_us) {
+
+        interval_us = us - diag->last_report_us;
+        if (diag->last_interval_us != 0) {
+            diff_us = (interval_us > diag->last_interval_us)
+                          ? interval_us - diag->last_interval_us
+                          : diag->last_interval_us - interval_us;
+            diag->jitter_sum_us += diff_us;
+            diag->jitter_count  += 1;
+        }
+        diag->last_interval_us = interval_us;
+    }
+    diag->last_report_us = us;
+
+    return;
+}
+
+
+//account for an input of a controller
+void diag_feed(int idx, const struct input_event * in_event) {
+
+    int key, delta, range;
+    uint64_t us;
+
+    struct diag_js * diag;
+    struct js_single_state * js;
+
+
+    if (_diag_is_on == false) return;
+
+    diag = _get_diag_js(idx);
+    us   = lat_tv_us(&in_event->time);
+
+    //frames
+    if (in_event->type == EV_SYN) {
+        if (in_event->code == SYN_REPORT) _feed_report(diag, us);
+        return;
+    }
+
+    key = _get_key_idx(in_event->type, in_event->code);
+    if (key < 0) return;
+
+    //buttons, timed from press to release
+    if (in_event->type == EV_KEY) {
+
+        if (in_event->value == 1) diag->press_us[key] = us;
+
+        if (in_event->value == 0 && diag->press_us[key] != 0) {
+            if (us >= diag->press_us[key])
+                diag->hold_us[key] = us - diag->press_us[key];
+            diag->press_us[key] = 0;
+        }
+        return;
+    }
+
+    //axes, changes small relative to the range are noise
+    js = cm_vct_get_p(&js_state.js, idx);
+    range = (js == NULL) ? 0 : js->info.abs_range[key];
+
+    if (diag->has_value[key] == true && range > 0) {
+
+        delta = abs(in_event->value - diag->last_value[key]);
+        if ((long) delta * 100 <= (long) range * DIAG_NOISE_PCT
+            && delta > diag->noise[key]) diag->noise[key] = delta;
+    }
+    diag->last_value[key] = in_event->value;
+    diag->has_value[key]  = true;
+
+    return;
+}
+
+
+//get a controller's diagnostics, NULL if it had no input yet
+const struct diag_js * diag_get(int idx) {
+
+    return cm_vct_get_p(&_diag_js, idx);
+}
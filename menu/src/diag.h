@@ -0,0 +1,75 @@
+#ifndef DIAG_H
+#define DIAG_H
+
+//C standard library
+#include <stdbool.h>
+#include <stdint.h>
+
+//external libraries
+#include <libevdev-1.0/libevdev/libevdev.h>
+
+//local headers
+#include "common.h"
+#include "event.h"
+#include "input.h"
+
+
+// -- [macros] --
+
+//statistics window length
+#define DIAG_WINDOW_MS 1000
+
+//axis changes below this share of the range count as noise
+#define DIAG_NOISE_PCT 5
+
+
+// -- [data] --
+
+//controller diagnostics
+struct diag_js {
+
+    //reports of the current window
+    uint64_t last_report_us;
+    uint64_t last_interval_us;
+    unsigned int reports;
+    unsigned int jitter_count;
+    uint64_t jitter_sum_us;
+
+    //axis noise of the current window
+    int last_value[KEY_OPT_NUM];
+    bool has_value[KEY_OPT_NUM];
+    int noise[KEY_OPT_NUM];
+
+    //button press times
+    uint64_t press_us[KEY_OPT_NUM];
+
+    //results of the last window & the last press of each button
+    double rate_hz;
+    double jitter_ms;
+    int noise_floor[KEY_OPT_NUM];
+    uint64_t hold_us[KEY_OPT_NUM];
+};
+
+
+//statistics change callback
+typedef void (* diag_change_cb)();
+
+
+// -- [text] --
+
+//initialise & release diagnostics, windows are timed on `loop`
+void init_diag(struct ev_loop * loop, diag_change_cb change_cb);
+void fini_diag();
+
+//start & stop collecting diagnostics
+void diag_start();
+void diag_stop();
+
+//account for an input of a controller
+void diag_feed(int idx, const struct input_event * in_event);
+
+//get a controller's diagnostics, NULL if it had no input yet
+const struct diag_js * diag_get(int idx);
+
+
+#endif
@@ -1,24 +1,21 @@
 /*
- *  NOTE: Underestimating the complexity of the task: the movie.
- *
- *        This code does not need to be extended, so this implementation
- *        will do. In the future however, an opcode based UI system
- *        should be used instead.
+ *  NOTE: Every window is a retained draw-list (see ui.h) laid out once
+ *        per terminal size. Nodes are bound to the menu state they show
+ *        & redrawn only when it changes. A new window needs a layout
+ *        function & the bind callbacks of its rows.
  */
 
 //C standard library
+#include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 
-//system headers
-#include <signal.h>
-#include <sys/statvfs.h>
-
 //kernel headers
 #include <linux/limits.h>
 
 //external libraries
-#include <ncurses.h>
 #include <cmore.h>
 
 //local headers
@@ -27,6 +24,12 @@
 #include "display.h"
 #include "input.h"
 #include "state.h"
+#include "latency.h"
+#include "diag.h"
+#include "render.h"
+#include "arena.h"
+#include "stats.h"
+#include "ui.h"
 
 
 // -- [macros] --
@@ -40,20 +43,24 @@
 #define GREEN_WHITE 6
 #define BLUE_WHITE  7
 
+//background cells of the screen & of windows
+#define SCRN_BKGD RND_CELL(' ', WHITE_BLACK)
+#define WIN_BKGD  RND_CELL(' ', BLACK_WHITE)
+
 //generic error string
-#define ERR_GENERIC "Ncurses encountered a fatal error."
+#define ERR_GENERIC "The display encountered a fatal error."
 
 //draw template sizes
 #define WIN_HDR_LEN 1
 #define WIN_FTR_LEN 4
 
-//miscellaneous menu constants
-#define INFO_STATIC_LEN 3
-#define INFO_KEY_STATE_OFF 18
-
 //stack draw buffer size
 #define DRAW_BUF_SZ NAME_MAX
 
+//window arena block size & the lines a menu first has room for
+#define ARENA_BLK_SZ (16 * 1024)
+#define OPTS_CAP 32
+
 
 // -- [data] --
 
@@ -90,7 +97,6 @@ struct win {
     int start_x;
 
     int hdr_start_y;
-    int hdr_start_x;
 
     int ftr_start_y;
     int ftr_start_x;
@@ -108,29 +114,91 @@ struct win {
 //menu selectable contents
 struct menu {
 
-    cm_vct opts;
+    //lines, allocated from the arena of the menu's window
+    struct arena * arena;
+    struct ui_span * opts;
+    int len;
+    int cap;
+
     bool is_init;
     int scroll;
 };
 
 
+//terminal output of each refresh, counted by the render backend
+struct out_stats {
+
+    uint64_t frames;
+    uint64_t frame_bytes;
+    uint64_t max_frame_bytes;
+};
+
+
 // -- [globals] --
 
 //screen & window data
 static struct scrn scrn;
 static struct win win;
 
+//output tracking
+static struct out_stats _out_stats;
+
+//colour pairs (fmt: fg:bg)
+static const struct rnd_pair _pairs[RND_PAIR_NUM] = {
+    [WHITE_BLACK] = {RND_WHITE, RND_BLACK},
+    [WHITE_BLUE]  = {RND_WHITE, RND_BLUE},
+    [WHITE_RED]   = {RND_WHITE, RND_RED},
+    [BLACK_WHITE] = {RND_BLACK, RND_WHITE},
+    [RED_WHITE]   = {RND_RED, RND_WHITE},
+    [GREEN_WHITE] = {RND_GREEN, RND_WHITE},
+    [BLUE_WHITE]  = {RND_BLUE, RND_WHITE}
+};
+
 //windows
-static WINDOW * main_win;
-static WINDOW * roms_win;
-static WINDOW * info_win;
+static struct rnd_surface * main_win;
+static struct rnd_surface * roms_win;
+static struct rnd_surface * info_win;
+static struct rnd_surface * diag_win;
+
+//window arenas, holding the lines of their menus
+static struct arena main_arena;
+static struct arena roms_arena;
+static struct arena info_arena;
+static struct arena diag_arena;
+
+//window draw-lists
+static struct ui_list main_ui;
+static struct ui_list roms_ui;
+static struct ui_list info_ui;
+static struct ui_list diag_ui;
+
+//window last drawn to the screen
+static struct rnd_surface * shown_win;
 
 //menues
 struct menu main_menu;
 struct menu roms_menu_0; //"back" option
-struct menu roms_menu_1; //ROMs
+struct menu roms_menu_1; //ROMs, only `scroll` is used
 struct menu info_menu_0; //"back" option
 struct menu info_menu_1; //info lines
+struct menu diag_menu_0; //"back" option
+struct menu diag_menu_1; //diagnostics lines
+
+//controller key descriptions, each value is printed in place of `%s`
+static char * _key_desc[KEY_OPT_NUM] = {
+    "B / SOUTH:        %s",
+    "A / EAST:         %s",
+    "X / NORTH:        %s",
+    "Y / WEST:         %s",
+    "LEFT TRIGGER      %s",
+    "RIGHT TRIGGER:    %s",
+    "SELECT:           %s",
+    "START:            %s",
+    "D-PAD X-AXIS      %s",
+    "D-PAD Y-AXIS:     %s",
+    "JOYSTICK X-AXIS:  %s",
+    "JOYSTICK Y-AXIS:  %s"
+};
 
 
 // -- [text] --
@@ -149,27 +217,11 @@ static void _populate_sz_constraints() {
 }
 
 
-//populate colours
-static void _populate_colours() {
-
-    //initialise global colour pairs (fmt: fg:bg)
-    init_pair(WHITE_BLACK, COLOR_WHITE, COLOR_BLACK);
-    init_pair(WHITE_BLUE, COLOR_WHITE, COLOR_BLUE);
-    init_pair(WHITE_RED, COLOR_WHITE, COLOR_RED);
-    init_pair(BLACK_WHITE, COLOR_BLACK, COLOR_WHITE);
-    init_pair(RED_WHITE, COLOR_RED, COLOR_WHITE);
-    init_pair(GREEN_WHITE, COLOR_GREEN, COLOR_WHITE);
-    init_pair(BLUE_WHITE, COLOR_BLUE, COLOR_WHITE);
-
-    return;
-}
-
-
 //populate screen dimensions
 static void _populate_dimensions() {
 
     //get the screen dimensions
-    getmaxyx(stdscr, scrn.sz_y, scrn.sz_x);
+    rnd_get_size(&scrn.sz_y, &scrn.sz_x);
     if ((scrn.sz_y < scrn.min_y) || (scrn.sz_x < scrn.min_x)) {
         FATAL_FAIL(ERR_GENERIC);
     }
@@ -182,9 +234,8 @@ static void _populate_dimensions() {
     win.start_y = (scrn.sz_y / 2) - (win.sz_y / 2);
     win.start_x = (scrn.sz_x / 2) - (win.sz_x / 2);
 
-    //calculate window header starting position
+    //calculate window header starting position, it's centered
     win.hdr_start_y = 1;
-    win.hdr_start_x = (win.sz_x / 2) - 9; //9 left of middle
 
     //calculate window footer starting position
     win.ftr_start_y = win.sz_y - WIN_FTR_LEN - 1;
@@ -201,41 +252,74 @@ static void _populate_dimensions() {
 }
 
 
-//construct a menu options vector
-static void _construct_opts(struct menu * menu) {
-
-    int ret;
-
+/*
+ *  NOTE: Menu lines are allocated from the arena of their window, which
+ *        is reset before the window's menus are populated again. Lines
+ *        of a previous population are never freed, so a window that is
+ *        re-entered or redrawn allocates nothing once its arena grew.
+ */
 
-    //teardown the old menu options vector if it was initialised
-    if (menu->is_init == true) {
-        cm_del_vct(&menu->opts);
-    }
+//construct a menu options array, reset the window's `arena` first
+static void _construct_opts(struct menu * menu, struct arena * arena) {
 
-    //construct a new entry vector
-    ret = cm_new_vct(&menu->opts, win.body_sz_x + 2); //2 for leeway :)
-    if (ret != 0) FATAL_FAIL(ERR_GENERIC);
+    menu->arena = arena;
+    menu->opts  = arena_alloc(arena, sizeof(struct ui_span) * OPTS_CAP);
+    menu->len   = 0;
+    menu->cap   = OPTS_CAP;
 
     //setup status
     menu->is_init = true;
     menu->scroll = 0;
+
+    return;
 }
 
 
-//destruct an entry vector
+//destruct an options array, its lines are freed with the arena
 static void _destruct_opts(struct menu * menu) {
 
-    //teardown the menu options vector
-    cm_del_vct(&menu->opts);
+    menu->opts = NULL;
+    menu->len  = 0;
+    menu->cap  = 0;
     menu->is_init = false;
 
     return;
 }
 
 
+//append a line to a menu's options, moving them to a larger array if full
+static void _append_opt(struct menu * menu, const struct ui_span * span) {
+
+    struct ui_span * opts;
+
+
+    if (menu->len == menu->cap) {
+
+        opts = arena_alloc(menu->arena,
+                           sizeof(struct ui_span) * menu->cap * 2);
+        memcpy(opts, menu->opts, sizeof(struct ui_span) * menu->len);
+        menu->opts = opts;
+        menu->cap *= 2;
+    }
+
+    memcpy(&menu->opts[menu->len], span, sizeof(*span));
+    menu->len += 1;
+
+    return;
+}
+
+
+//get a menu line, NULL past the last one
+static struct ui_span * _get_opt(struct menu * menu, int idx) {
+
+    if (idx < 0 || idx >= menu->len) return NULL;
+    return &menu->opts[idx];
+}
+
+
 //build a display line
 static void _build_line_buf(
-    char * str, size_t len, size_t max_len, char * buf, bool centered) {
+    const char * str, size_t len, size_t max_len, char * buf, bool centered) {
 
     size_t diff_len;
 
@@ -251,14 +335,14 @@ static void _build_line_buf(
         if (centered == true) {
             memset(buf, ' ', diff_len);
             memcpy(buf + diff_len, str, len);
-            memset(buf + diff_len + len, ' ', diff_len);
+            memset(buf + diff_len + len, ' ', max_len - diff_len - len);
         } else {
             memcpy(buf, str, len);
-            memset(buf + len, ' ', diff_len * 2);
+            memset(buf + len, ' ', max_len - len);
         }
 
     //else this entry does not fit inside the option space
-    } else {
+    } else if (len > max_len) {
         memcpy(buf, str, max_len - 2);
         buf[max_len - 2] = '.';
         buf[max_len - 1] = '.';
@@ -269,36 +353,85 @@ static void _build_line_buf(
 }
 
 
-//populate main menu entries
-static void _populate_main_menu() {
+//get the visible row count of a submenu with `len` lines
+static int _get_submenu_sz(struct menu * menu_0, int len) {
+
+    int submenu_sz = win.body_sz_y - menu_0->len - 1;
+    return (len > submenu_sz) ? submenu_sz : len;
+}
+
+
+//append a line to a menu
+static void _append_line(struct menu * menu, char * str, bool centered) {
 
-    int ret;
     char draw_buf[DRAW_BUF_SZ];
+    struct ui_span span;
+
+
+    //build the line buffer
+    _build_line_buf(str, strnlen(str, NAME_MAX),
+                    win.body_sz_x, draw_buf, centered);
+    ui_span_clear(&span);
+    ui_span_put(&span, BLACK_WHITE, draw_buf, win.body_sz_x);
+
+    //append this entry
+    _append_opt(menu, &span);
+
+    return;
+}
 
 
+//append a controller key line to a menu, its value in `colour`
+static void _append_key_line(struct menu * menu, int key,
+                             char * value, int colour) {
+
+    int value_off;
+    char draw_buf[DRAW_BUF_SZ], line_buf[DRAW_BUF_SZ];
+    struct ui_span span;
+
+
+    //the value starts where the description's `%s` is
+    value_off = strchr(_key_desc[key], '%') - _key_desc[key];
+
+    //build the line buffer
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wformat-security"
+    snprintf(line_buf, win.body_sz_x, _key_desc[key], value);
+    #pragma GCC diagnostic pop
+    _build_line_buf(line_buf, strnlen(line_buf, win.body_sz_x),
+                    win.body_sz_x, draw_buf, false);
+
+    //colour the value separately
+    ui_span_clear(&span);
+    ui_span_put(&span, BLACK_WHITE, draw_buf, value_off);
+    ui_span_put(&span, colour, draw_buf + value_off,
+                win.body_sz_x - value_off);
+
+    //append this entry
+    _append_opt(menu, &span);
+
+    return;
+}
+
+
+//populate main menu entries
+static void _populate_main_menu() {
+
     char * main_opts[MAIN_MENU_OPTS] = {
         "PLAY",
         "INFO",
+        "DIAGNOSTICS",
         "POWER OFF"
     };
-    size_t main_opts_sz[MAIN_MENU_OPTS] = {4, 4, 9};
 
 
     //reset the main menu options
-    _construct_opts(&main_menu);
+    arena_reset(&main_arena);
+    _construct_opts(&main_menu, &main_arena);
 
     //populate options
-    for (int i = 0; i < MAIN_MENU_OPTS; ++i) {
-
-        //build the option buffer
-        _build_line_buf(
-            main_opts[i], main_opts_sz[i],
-            win.body_sz_x, draw_buf, true);
-
-        //append this entry
-        ret = cm_vct_apd(&main_menu.opts, draw_buf);
-        if (ret != 0) FATAL_FAIL(ERR_GENERIC)
-    }
+    for (int i = 0; i < MAIN_MENU_OPTS; ++i)
+        _append_line(&main_menu, main_opts[i], true);
 
     return;
 }
@@ -313,42 +446,21 @@ static void _teardown_main_menu() {
 }
 
 
-//populate ROMs menu entries
-static void _populate_roms_menu() {
-
-    int ret;
-
-    size_t len;
-    char * basename;
-    char draw_buf[DRAW_BUF_SZ];
+/*
+ *  NOTE: ROM options are not stored. Only the rows in view are formatted
+ *        from the open folder's items when they change, so neither
+ *        memory nor the cost of entering the window depends on the size
+ *        of the library.
+ */
 
+static void _populate_roms_menu() {
 
     //reset the ROMs menu options
-    _construct_opts(&roms_menu_0);
-    _construct_opts(&roms_menu_1);
+    arena_reset(&roms_arena);
+    _construct_opts(&roms_menu_0, &roms_arena);
 
     //populate the back option
-    _build_line_buf("BACK", 4, win.body_sz_x, draw_buf, true);
-
-    //append this entry
-    ret = cm_vct_apd(&roms_menu_0.opts, draw_buf);
-    if (ret != 0) FATAL_FAIL(ERR_GENERIC)
-
-    //populate options
-    for (int i = 0; i < rom_basenames.len; ++i) {
-
-        //get the next ROM entry
-        basename = cm_vct_get_p(&rom_basenames, i);
-        if (basename == NULL) FATAL_FAIL(ERR_GENERIC)
-        len = strnlen(basename, NAME_MAX);
-
-        //build the option buffer
-        _build_line_buf(basename, len, win.body_sz_x, draw_buf, false);
-
-        //append this entry
-        ret = cm_vct_apd(&roms_menu_1.opts, draw_buf);
-        if (ret != 0) FATAL_FAIL(ERR_GENERIC)
-    }
+    _append_line(&roms_menu_0, "BACK", true);
     
     return;
 }
@@ -359,7 +471,6 @@ static void _teardown_rom_menu() {
 
     //teardown the main menu options
     _destruct_opts(&roms_menu_0);
-    _destruct_opts(&roms_menu_1);
     return;
 }
 
@@ -367,124 +478,127 @@ static void _teardown_rom_menu() {
 //populate info menu entries
 static void _populate_info_menu() {
 
-    int ret;
     int controller_count;
 
-    struct statvfs stat;
-    unsigned long free_mb;
-    
-    char draw_buf[NAME_MAX], line_buf[NAME_MAX];
-    char * key_desc[KEY_OPT_NUM] = {
-        "B / SOUTH:        %s",
-        "A / EAST:         %s",
-        "X / NORTH:        %s",
-        "Y / WEST:         %s",
-        "LEFT TRIGGER      %s",
-        "RIGHT TRIGGER:    %s",
-        "SELECT:           %s",
-        "START:            %s",
-        "D-PAD X-AXIS      %s",
-        "D-PAD Y-AXIS:     %s",
-        "JOYSTICK X-AXIS:  %s",
-        "JOYSTICK Y-AXIS:  %s"
-    };
+    struct js_info * js;
+    struct sys_stats stats;
+
+    char line_buf[NAME_MAX], stage_buf[KEY_DESC_LEN];
 
 
     //reset the info menu options
-    _construct_opts(&info_menu_0);
-    _construct_opts(&info_menu_1);
+    arena_reset(&info_arena);
+    _construct_opts(&info_menu_0, &info_arena);
+    _construct_opts(&info_menu_1, &info_arena);
 
     //populate the back option
-    _build_line_buf("BACK", 4, win.body_sz_x, draw_buf, true);
+    _append_line(&info_menu_0, "BACK", true);
 
-    //append this entry
-    ret = cm_vct_apd(&info_menu_0.opts, draw_buf);
-    if (ret != 0) FATAL_FAIL(ERR_GENERIC)
 
+    //populate system statistics from the last snapshot
+    stats_get(&stats);
 
-    //populate the ROM count
-    snprintf(line_buf, win.body_sz_x, "ROMS:       %d",
-             rom_basenames.len);
-    _build_line_buf(line_buf, strnlen(line_buf, win.body_sz_x),
-                    win.body_sz_x, draw_buf, false);
+    if (stats.rom_count == -1) {
+        snprintf(line_buf, win.body_sz_x, "ROMS:       -");
+    } else {
+        snprintf(line_buf, win.body_sz_x, "ROMS:       %d", stats.rom_count);
+    }
+    _append_line(&info_menu_1, line_buf, false);
 
-    //append this entry
-    ret = cm_vct_apd(&info_menu_1.opts, draw_buf);
-    if (ret != 0) FATAL_FAIL(ERR_GENERIC)
+    snprintf(line_buf, win.body_sz_x, "FREE SPACE: %lu/%lu MB",
+             stats.rom_free_mb, stats.rom_total_mb);
+    _append_line(&info_menu_1, line_buf, false);
 
+    snprintf(line_buf, win.body_sz_x, "FREE MEM:   %lu/%lu MB",
+             stats.mem_free_mb, stats.mem_total_mb);
+    _append_line(&info_menu_1, line_buf, false);
 
-    //populate disk space
-    ret = statvfs("/", &stat);
-    if (ret != 0) FATAL_FAIL(ERR_GENERIC)
-    free_mb = (stat.f_bfree * stat.f_frsize)  / (1024 * 1024);
-    snprintf(line_buf, win.body_sz_x, "FREE SPACE: %lu MB", free_mb);
-    _build_line_buf(line_buf, strnlen(line_buf, win.body_sz_x),
-                    win.body_sz_x, draw_buf, false);
+    snprintf(line_buf, win.body_sz_x, "LOAD:       %.2f", stats.load);
+    _append_line(&info_menu_1, line_buf, false);
 
-    //append this entry
-    ret = cm_vct_apd(&info_menu_1.opts, draw_buf);
-    if (ret != 0) FATAL_FAIL(ERR_GENERIC)
+    //populate the age of the snapshot
+    if (stats.taken_ms == 0) {
+        snprintf(line_buf, win.body_sz_x, "UPDATED:    PENDING");
+    } else {
+        snprintf(line_buf, win.body_sz_x, "UPDATED:    %lu S AGO",
+                 (unsigned long) ((mono_ms() - stats.taken_ms) / 1000));
+    }
+    _append_line(&info_menu_1, line_buf, false);
+
+    //populate the input frames lost to device buffer overflows
+    snprintf(line_buf, win.body_sz_x, "DROPPED:    %lu",
+             js_state.dropped_frames);
+    _append_line(&info_menu_1, line_buf, false);
 
+    //populate the terminal output of an average & the largest frame
+    if (rnd_written() == -1) {
+        snprintf(line_buf, win.body_sz_x, "FRAME AVG:  -");
+    } else {
+        snprintf(line_buf, win.body_sz_x, "FRAME AVG:  %lu/%lu B MAX",
+                 (unsigned long) ((_out_stats.frames == 0)
+                     ? 0 : _out_stats.frame_bytes / _out_stats.frames),
+                 (unsigned long) _out_stats.max_frame_bytes);
+    }
+    _append_line(&info_menu_1, line_buf, false);
 
     //populate the version
     snprintf(line_buf, win.body_sz_x, "VERSION:    %s", VERSION);
-    _build_line_buf(line_buf, strnlen(line_buf, win.body_sz_x),
-                    win.body_sz_x, draw_buf, false);
+    _append_line(&info_menu_1, line_buf, false);
 
-    //append this entry
-    ret = cm_vct_apd(&info_menu_1.opts, draw_buf);
-    if (ret != 0) FATAL_FAIL(ERR_GENERIC)
+    //populate a newline
+    _append_line(&info_menu_1, "", false);
 
 
+    //populate the input latency of each stage
+    _append_line(&info_menu_1, "LATENCY MS: P50/P99/MAX", true);
+
+    for (int i = 0; i < LAT_STAGE_NUM; ++i) {
+
+        snprintf(stage_buf, sizeof(stage_buf), "%s:", lat_stage_str(i));
+        snprintf(line_buf, win.body_sz_x, "%-12s%.1f/%.1f/%.1f", stage_buf,
+                 lat_percentile(i, 50) / 1000.0,
+                 lat_percentile(i, 99) / 1000.0, lat_max(i) / 1000.0);
+        _append_line(&info_menu_1, line_buf, false);
+    }
+
     //populate a newline
-    memset(draw_buf, 0, DRAW_BUF_SZ);
-    
-    //append this entry
-    ret = cm_vct_apd(&info_menu_1.opts, draw_buf);
-    if (ret != 0) FATAL_FAIL(ERR_GENERIC)
+    _append_line(&info_menu_1, "", false);
 
 
     //populate controller keymaps
     controller_count = 0;
-    for (int i = 0; i < 4; ++i) {
+    for (int i = 0; i < js_state.js.len; ++i) {
 
         //skip this joystick if it isn't present
-        if (js_state.js[i].is_present == false) continue;
+        js = &((struct js_single_state *) cm_vct_get_p(&js_state.js, i))->info;
+        if (js->status == JS_ABSENT) continue;
 
         //add a new line for subsequent controllers
-        if (controller_count != 0) {
-            //populate a newline
-            memset(draw_buf, 0, DRAW_BUF_SZ);
-    
-            //append this entry
-            ret = cm_vct_apd(&info_menu_1.opts, draw_buf);
-            if (ret != 0) FATAL_FAIL(ERR_GENERIC)
-        }
+        if (controller_count != 0) _append_line(&info_menu_1, "", false);
         controller_count += 1;
 
         snprintf(line_buf, win.body_sz_x, "CONTROLLER %d KEYMAP:", i + 1);
-        _build_line_buf(line_buf, strnlen(line_buf, win.body_sz_x),
-                        win.body_sz_x, draw_buf, true);
+        _append_line(&info_menu_1, line_buf, true);
 
-        //append this entry
-        ret = cm_vct_apd(&info_menu_1.opts, draw_buf);
-        if (ret != 0) FATAL_FAIL(ERR_GENERIC)
+        //add the controller's status & its consecutive failures
+        if (js->status == JS_FAILED) {
+            snprintf(line_buf, win.body_sz_x, "STATUS:           %s x%d",
+                     js_status_str(js->status),
+                     js->fail_count);
+        } else {
+            snprintf(line_buf, win.body_sz_x, "STATUS:           %s",
+                     js_status_str(js->status));
+        }
+        _append_line(&info_menu_1, line_buf, false);
 
-        //add all keys
+        //add all keys, their availability in colour
         for (int j = 0; j < KEY_OPT_NUM; ++j) {
 
-            //build the next key entry
-            #pragma GCC diagnostic push
-            #pragma GCC diagnostic ignored "-Wformat-security"
-            snprintf(line_buf, win.body_sz_x, key_desc[j],
-                     (js_state.js[i].keys[j] == true) ? "YES" : "NO");
-            #pragma GCC diagnostic pop
-            _build_line_buf(line_buf, strnlen(line_buf, win.body_sz_x),
-                            win.body_sz_x, draw_buf, false);
-
-            //append this entry
-            ret = cm_vct_apd(&info_menu_1.opts, draw_buf);
-            if (ret != 0) FATAL_FAIL(ERR_GENERIC)
+            if (js->keys[j] == true) {
+                _append_key_line(&info_menu_1, j, "YES", GREEN_WHITE);
+            } else {
+                _append_key_line(&info_menu_1, j, "NO", RED_WHITE);
+            }
 
         } //end add all keys
 
@@ -508,28 +622,15 @@ static void _teardown_info_menu() {
 //initialise windows
 static void _init_wins() {
 
-    int ret;
-
-
     //create windows
-    main_win = newwin(win.sz_y, win.sz_x, win.start_y, win.start_x);
-    if (main_win == NULL) FATAL_FAIL(ERR_GENERIC)
-
-    roms_win  = newwin(win.sz_y, win.sz_x, win.start_y, win.start_x);
-    if (roms_win == NULL) FATAL_FAIL(ERR_GENERIC)
-
-    info_win  = newwin(win.sz_y, win.sz_x, win.start_y, win.start_x);
-    if (info_win == NULL) FATAL_FAIL(ERR_GENERIC)
-
-    //set window background colours
-    ret = wbkgd(main_win, COLOR_PAIR(BLACK_WHITE));
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
-
-    ret = wbkgd(roms_win, COLOR_PAIR(BLACK_WHITE));
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
-
-    ret = wbkgd(info_win, COLOR_PAIR(BLACK_WHITE));
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+    main_win = rnd_new_surface(win.start_y, win.start_x,
+                               win.sz_y, win.sz_x, WIN_BKGD);
+    roms_win = rnd_new_surface(win.start_y, win.start_x,
+                               win.sz_y, win.sz_x, WIN_BKGD);
+    info_win = rnd_new_surface(win.start_y, win.start_x,
+                               win.sz_y, win.sz_x, WIN_BKGD);
+    diag_win = rnd_new_surface(win.start_y, win.start_x,
+                               win.sz_y, win.sz_x, WIN_BKGD);
 
     return;
 }
@@ -538,20 +639,17 @@ static void _init_wins() {
 //release windows
 static void _fini_wins() {
 
-    int ret;
-
-
     //release windows
-    ret = delwin(info_win);
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+    rnd_del_surface(diag_win);
+    diag_win = NULL;
+
+    rnd_del_surface(info_win);
     info_win = NULL;
 
-    ret = delwin(roms_win);
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+    rnd_del_surface(roms_win);
     roms_win = NULL;
 
-    ret = delwin(main_win);
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+    rnd_del_surface(main_win);
     main_win = NULL;
 
     return;
@@ -561,417 +659,713 @@ static void _fini_wins() {
 //perform initialisation
 void _initialise() {
 
-    int ret;
-    void * ret_ptr;
+    //start the render backend
+    init_render(_pairs, SCRN_BKGD);
 
+    //populate globals
+    _populate_sz_constraints();
+    _populate_dimensions();
+    _populate_main_menu();
+
+    return;
+}
+
+
+//return the colour for a menu option
+static int _get_menu_opt_colour(int pos, int cur_pos) {
+
+    return (cur_pos == pos) ? WHITE_BLUE : BLACK_WHITE;
+}
+
+
+//return the colour for a ROMs menu option
+static int _get_roms_menu_opt_colour(int pos, int cur_pos) {
     
-    //general setup
-    ret_ptr = initscr();
-    if (ret_ptr == NULL) FATAL_FAIL(ERR_GENERIC)
-    
-    ret = cbreak();
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+    if (cur_pos == pos) {
+        return subsys_state.execve_good ? WHITE_BLUE : WHITE_RED;
+    } else { return BLACK_WHITE; }
+}
 
-    ret = keypad(stdscr, false);
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
 
-    ret = noecho();
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+//get a controller's footer status tag & its colour
+static char * _get_ftr_status(enum js_status status, int * colour) {
 
-    ret = start_color();
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+    switch (status) {
 
-    //populate globals
-    _populate_sz_constraints();
-    _populate_colours();
-    _populate_dimensions();
-    _populate_main_menu();
+        case JS_OPEN:
+            *colour = GREEN_WHITE;
+            return "OK ";
 
-    //setup root window
-    ret = bkgd(COLOR_PAIR(WHITE_BLACK));
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+        case JS_FAILED:
+            *colour = RED_WHITE;
+            return "!! ";
 
+        case JS_PROBING:
+            *colour = BLACK_WHITE;
+            return ".. ";
+
+        default:
+            *colour = RED_WHITE;
+            return "?? ";
+
+    } //end switch
+}
+
+
+//build the footer span of one controller
+static void _span_ftr_controller(struct ui_span * span, int idx) {
+
+    int colour;
+    char * status;
+    struct js_single_state * js;
+
+
+    //controller index
+    ui_span_add(span, BLACK_WHITE, "CONTROLLER %d: ", idx + 1);
+
+    //if the controller is present
+    js = cm_vct_get_p(&js_state.js, idx);
+    if (js == NULL || js->info.status == JS_ABSENT) return;
+
+    //controller status
+    status = _get_ftr_status(js->info.status, &colour);
+    ui_span_put(span, colour, status, 3);
+
+    //tag the controller that last drove the menu
+    if (js_state.active_js_idx == idx) {
+
+        ui_span_put(span, BLACK_WHITE, "[", 1);
+        ui_span_put(span, BLUE_WHITE, "M", 1);
+        ui_span_put(span, BLACK_WHITE, "]", 1);
+    }
 
     return;
 }
 
 
-//handle a terminal resize
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-parameter"
-void _handle_winch(int sig) {
+//build a footer row summarising controllers that don't fit
+static void _span_ftr_summary(struct ui_span * span,
+                              int row, int present_count) {
 
-    int ret;
+    int colour;
+    char * status;
+    int counts[JS_DIAG + 1] = {0};
 
+    struct js_single_state * js;
 
-    //erase screen contents
-    ret = erase();
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
-    ret = refresh();
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+    const enum js_status order[] = {JS_OPEN, JS_FAILED,
+                                    JS_UNUSABLE, JS_PROBING};
 
-    //release windows
-    _fini_wins();
 
-    //reset ncurses
-    ret = endwin();
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+    //the controller count
+    if (row == 0) {
+        ui_span_add(span, BLACK_WHITE, "CONTROLLERS: %d", present_count);
+        return;
+    }
 
-    //re-initialise ncurses
-    _initialise();
+    //the controller that last drove the menu
+    if (row == 2 && js_state.active_js_idx >= 0) {
+        _span_ftr_controller(span, js_state.active_js_idx);
+        return;
+    }
+    if (row != 1) return;
 
-    //re-initialise windows
-    _init_wins();
-    if (menu_state.current_win == MAIN)
-        menu_state.current_win_ptr = main_win;
-    if (menu_state.current_win == ROMS) {
-        menu_state.current_win_ptr = roms_win;
-        _populate_roms_menu();
+    //count controllers in each status
+    for (int i = 0; i < js_state.js.len; ++i) {
+        js = cm_vct_get_p(&js_state.js, i);
+        counts[js->info.status] += 1;
     }
-    if (menu_state.current_win == INFO) {
-        menu_state.current_win_ptr = info_win;
-        _populate_info_menu();
+
+    //controllers read for diagnostics are still unusable
+    counts[JS_UNUSABLE] += counts[JS_DIAG];
+
+    //the count of each status
+    for (int i = 0; i < 4; ++i) {
+
+        status = _get_ftr_status(order[i], &colour);
+        ui_span_add(span, colour, "%.2s %d ", status, counts[order[i]]);
     }
 
     return;
 }
+
+
+/*
+ *  NOTE: Up to WIN_FTR_LEN controller slots are listed as before, empty
+ *        slots included. Larger tables list only present controllers,
+ *        falling back to a summary when those don't fit either.
+ */
+
+//key the footer rows on the controller table
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static uint64_t _key_ftr_row(int row) {
 #pragma GCC diagnostic pop
 
+    return js_state.gen;
+}
 
-//initialise ncurses global state
-void init_ncurses() {
 
-    __sighandler_t ret_hdlr;
+//bind a footer row
+static void _bind_ftr_row(int row, struct ui_span * span) {
 
+    int present_count;
+    struct js_single_state * js;
 
-    //initialise ncurses
-    _initialise();
 
-    //register a SIGWINCH handler
-    ret_hdlr = signal(SIGWINCH, _handle_winch);
-    if (ret_hdlr == SIG_ERR)
-        FATAL_FAIL("Failed to register a SIGWINCH handler.")
+    //list slots in order
+    if (js_state.js.len <= WIN_FTR_LEN) {
+        _span_ftr_controller(span, row);
+        return;
+    }
 
-    //initialise windows
-    _init_wins();
+    present_count = 0;
+    for (int i = 0; i < js_state.js.len; ++i) {
+        js = cm_vct_get_p(&js_state.js, i);
+        if (js->info.status != JS_ABSENT) present_count += 1;
+    }
 
-    //update menu state
-    menu_state.current_win_ptr = main_win;
+    //summarise controllers that don't fit
+    if (present_count > WIN_FTR_LEN) {
+        _span_ftr_summary(span, row, present_count);
+        return;
+    }
+
+    //list present controllers, find the one on this row
+    present_count = 0;
+    for (int i = 0; i < js_state.js.len; ++i) {
+
+        js = cm_vct_get_p(&js_state.js, i);
+        if (js->info.status == JS_ABSENT) continue;
+
+        if (present_count == row) {
+            _span_ftr_controller(span, i);
+            return;
+        }
+        present_count += 1;
+    }
 
     return;
 }
 
 
-//release ncurses global state
-void fini_ncurses() {
+//build the span of a menu line, recoloured unless it's `BLACK_WHITE`
+static void _span_menu_line(struct ui_span * span,
+                            struct menu * menu, int idx, int colour) {
 
-    int ret;
+    struct ui_span * line;
 
 
-    //release windows
-    _fini_wins();
+    //rows past the last line stay blank
+    line = _get_opt(menu, idx);
+    if (line == NULL) return;
 
-    //disable ncurses
-    ret = endwin();
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+    if (colour == BLACK_WHITE) {
+        memcpy(span, line, sizeof(*span));
+    } else {
+        ui_span_put(span, colour, line->text, line->len);
+    }
 
     return;
 }
 
 
-//draw a single line, in colour
-static void _draw_colour(WINDOW * win, int colour,
-                         int * y, int * x, char * str,
-                         int off_y, int off_x) {
+//bind a main menu option
+static void _bind_main_opt(int pos, struct ui_span * span) {
 
-    //enable a colour attribute
-    if (wattron(win, COLOR_PAIR(colour)) == ERR)
-        FATAL_FAIL(ERR_GENERIC)
+    _span_menu_line(span, &main_menu, pos,
+                    _get_menu_opt_colour(pos, menu_state.main_menu_pos));
+    return;
+}
 
-    //perform the draw
-    #pragma GCC diagnostic push
-    #pragma GCC diagnostic ignored "-Wformat-security"
-    mvwprintw(win, *y, *x, str);
-    #pragma GCC diagnostic pop
 
-    //disable a colour attribute
-    if (wattroff(win, COLOR_PAIR(colour)) == ERR)
-        FATAL_FAIL(ERR_GENERIC)
+//bind the "BACK" option of a window
+static void _bind_back_opt(int window, struct ui_span * span) {
+
+    switch (window) {
+
+        case ROMS:
+            _span_menu_line(span, &roms_menu_0, 0,
+                _get_menu_opt_colour(0, menu_state.roms_menu_pos));
+            break;
 
-    //advance y and x
-    *y += off_y;
-    *x += off_x;
+        case INFO:
+            _span_menu_line(span, &info_menu_0, 0,
+                _get_menu_opt_colour(0, menu_state.info_menu_pos));
+            break;
+
+        case DIAG:
+            _span_menu_line(span, &diag_menu_0, 0,
+                _get_menu_opt_colour(0, menu_state.diag_menu_pos));
+            break;
+
+    } //end switch
 
     return;
 }
 
 
-//draw a single line, in colour
-static void _draw_substr_colour(WINDOW * win, int colour,
-                                int * y, int * x,
-                                char * str, int len,
-                                int off_y, int off_x) {
+//key a visible row of the ROMs menu on its item & whether it's selected
+static uint64_t _key_roms_row(int row) {
 
-    //enable a colour attribute
-    if (wattron(win, COLOR_PAIR(colour)) == ERR)
-        FATAL_FAIL(ERR_GENERIC)
+    int item_idx;
+    bool is_sel;
 
-    //perform the draw
-    #pragma GCC diagnostic push
-    #pragma GCC diagnostic ignored "-Wformat-security"
-    mvwprintw(win, *y, *x, "%.*s", len, str);
-    #pragma GCC diagnostic pop
 
-    //disable a colour attribute
-    if (wattroff(win, COLOR_PAIR(colour)) == ERR)
-        FATAL_FAIL(ERR_GENERIC)
+    item_idx = roms_menu_1.scroll + row;
+    is_sel   = (item_idx == menu_state.roms_menu_pos - ROMS_MENU_OPTS);
+
+    return ((uint64_t) rom_items_gen << 34) | ((uint64_t) item_idx << 2)
+           | (is_sel << 1) | subsys_state.execve_good;
+}
+
+
+//bind a visible row of the ROMs menu
+static void _bind_roms_row(int row, struct ui_span * span) {
+
+    int ret, item_idx, name_len, colour;
+    const char * name;
+    char draw_buf[DRAW_BUF_SZ];
+    struct rom_item item;
+
+
+    //get the item in this row, accounting for menu scroll
+    item_idx = roms_menu_1.scroll + row;
+    ret = get_rom_item(item_idx, &item);
+    if (ret != 0) return;
+
+    //format the option straight from the ROM list
+    name = get_rom_item_name(&item, &name_len);
+    _build_line_buf(name, name_len, win.body_sz_x, draw_buf, false);
 
-    //advance y and x
-    *y += off_y;
-    *x += off_x;
+    colour = _get_roms_menu_opt_colour(
+                 item_idx, menu_state.roms_menu_pos - ROMS_MENU_OPTS);
+    ui_span_put(span, colour, draw_buf, win.body_sz_x);
 
     return;
 }
 
 
-//return the colour for a menu option
-static int _get_menu_opt_colour(int pos, int cur_pos) {
+//key the row below the ROMs menu's "BACK" option on the walk & folder
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static uint64_t _key_roms_status(int arg) {
+#pragma GCC diagnostic pop
 
-    return (cur_pos == pos) ? WHITE_BLUE : BLACK_WHITE;
+    return ((uint64_t) rom_items_gen << 32)
+           | (uint32_t) (scan_progress_roms() + 1);
 }
 
 
-//return the colour for a ROMs menu option
-static int _get_roms_menu_opt_colour(int pos, int cur_pos) {
-    
-    if (cur_pos == pos) {
-        return subsys_state.execve_good ? WHITE_BLUE : WHITE_RED;
-    } else { return BLACK_WHITE; }
+//bind the row below the ROMs menu's "BACK" option, the walk or folder
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _bind_roms_status(int arg, struct ui_span * span) {
+#pragma GCC diagnostic pop
+
+    int found;
+    char draw_buf[DRAW_BUF_SZ], line_buf[DRAW_BUF_SZ];
+
+
+    //a walk in progress is shown over the open folder
+    found = scan_progress_roms();
+    if (found != -1) {
+        snprintf(line_buf, win.body_sz_x, "SCANNING... %d FOUND", found);
+    } else if (rom_folder[0] != '\0') {
+        snprintf(line_buf, win.body_sz_x, "/%s", rom_folder);
+    } else {
+        return;
+    }
+
+    _build_line_buf(line_buf, strnlen(line_buf, win.body_sz_x),
+                    win.body_sz_x, draw_buf, false);
+    ui_span_put(span, BLACK_WHITE, draw_buf, win.body_sz_x);
+
+    return;
 }
 
 
-static int _get_submenu_sz(struct menu * menu_0, struct menu * menu_1) {
+//bind a visible row of the info menu
+static void _bind_info_row(int row, struct ui_span * span) {
 
-    int submenu_sz = win.body_sz_y - menu_0->opts.len - 1;
-    return (menu_1->opts.len > submenu_sz)
-             ? submenu_sz : menu_1->opts.len;
-    
+    _span_menu_line(span, &info_menu_1,
+                    info_menu_1.scroll + row, BLACK_WHITE);
+    return;
+}
+
+
+//bind a visible row of the diagnostics menu
+static void _bind_diag_row(int row, struct ui_span * span) {
+
+    _span_menu_line(span, &diag_menu_1,
+                    diag_menu_1.scroll + row, BLACK_WHITE);
+    return;
 }
 
 
-//draw the window template
-static void _draw_template(WINDOW * window) {
+//lay out the header & footer every window shares
+static void _layout_template(struct ui_list * list) {
 
-    int y, x;
-    char draw_buf[DRAW_BUF_SZ] = {0};
+    int ret;
+    struct ui_span span;
 
 
-    //draw the header
-    y = win.hdr_start_y; x = win.hdr_start_x;
-    _draw_colour(window, BLACK_WHITE, &y, &x, "--- [", 0, 5);
-    _draw_colour(window, RED_WHITE, &y, &x, "SUPER", 0, 5);
-    _draw_colour(window, GREEN_WHITE, &y, &x, "-", 0, 1);
-    _draw_colour(window, BLUE_WHITE, &y, &x, "PI", 0, 2);
-    _draw_colour(window, BLACK_WHITE, &y, &x, "] ---", 0, 5);
+    //the header, centered
+    ui_span_clear(&span);
+    ui_span_put(&span, BLACK_WHITE, "--- [", 5);
+    ui_span_put(&span, RED_WHITE, "SUPER", 5);
+    ui_span_put(&span, GREEN_WHITE, "-", 1);
+    ui_span_put(&span, BLUE_WHITE, "PI", 2);
+    ui_span_put(&span, BLACK_WHITE, "] ---", 5);
 
+    ret = ui_add_text(list, win.hdr_start_y, (win.sz_x - span.len) / 2,
+                      span.len, &span);
+    if (ret != 0) FATAL_FAIL(ERR_GENERIC)
 
-    //draw the footer - for each controller
-    for (int i = 0; i < 4; ++i) {
+    //the footer rows, up to the window's right edge
+    for (int i = 0; i < WIN_FTR_LEN; ++i) {
+
+        ret = ui_add_bind(list, win.ftr_start_y + i, win.ftr_start_x,
+                          win.sz_x - win.ftr_start_x,
+                          _bind_ftr_row, _key_ftr_row, i);
+        if (ret != 0) FATAL_FAIL(ERR_GENERIC)
+    }
 
-        //reset the draw position
-        y = win.ftr_start_y + i; x = win.ftr_start_x;
+    return;
+}
 
-        //draw controller index
-        snprintf(draw_buf, DRAW_BUF_SZ, "CONTROLLER %d: ", i + 1);
-        _draw_colour(window, BLACK_WHITE, &y, &x, draw_buf, 0, 14);
-        
-        //if the controller is present
-        if (js_state.js[i].is_present == true) {
 
-            //draw controller status
-            if (js_state.js[i].is_good == false) {
-                _draw_colour(window, RED_WHITE, &y, &x, "?? ", 0, 3);
-            } else {
-                _draw_colour(window, GREEN_WHITE, &y, &x, "OK ", 0, 3);
-            }
+//lay out a window listing `bind_row` rows below a "BACK" option, keyed
+//by `key_row` if it isn't NULL
+static void _layout_submenu(struct ui_list * list, enum menu_window window,
+                            ui_bind_cb bind_row, ui_key_cb key_row) {
 
-            //draw an additional tag
-            if (js_state.main_js_idx == i) {
+    int ret;
+    int rows;
 
-                _draw_colour(window, BLACK_WHITE, &y, &x, "[", 0, 1);
-                _draw_colour(window, BLUE_WHITE, &y, &x, "M", 0, 1);
-                _draw_colour(window, BLACK_WHITE, &y, &x, "]", 0, 1);
-            }
-            
-        } //end if controller is present
 
-    } //end for each controller
+    _layout_template(list);
+
+    ret = ui_add_bind(list, win.body_start_y, win.body_start_x,
+                      win.body_sz_x, _bind_back_opt, NULL, window);
+    if (ret != 0) FATAL_FAIL(ERR_GENERIC)
+
+    //a blank row separates the "BACK" option
+    rows = win.body_sz_y - 2;
+    for (int i = 0; i < rows; ++i) {
+
+        ret = ui_add_bind(list, win.body_start_y + 2 + i, win.body_start_x,
+                          win.body_sz_x, bind_row, key_row, i);
+        if (ret != 0) FATAL_FAIL(ERR_GENERIC)
+    }
 
     return;
 }
 
 
-//draw the main menu
-static void _draw_main_menu() {
+//lay every window out for the current window size
+static void _layout_wins() {
 
-    int y, x;
-    int colour;
-    char * main_opt;
+    int ret;
 
 
-    y = win.body_start_y;
-    x = win.body_start_x;
+    ui_clear(&main_ui);
+    ui_clear(&roms_ui);
+    ui_clear(&info_ui);
+    ui_clear(&diag_ui);
 
-    //for each main menu option
+    //main window
+    _layout_template(&main_ui);
     for (int i = 0; i < MAIN_MENU_OPTS; ++i) {
 
-        //get the next option
-        main_opt = cm_vct_get_p(&main_menu.opts, i);
-        if (main_opt == NULL) FATAL_FAIL(ERR_GENERIC)
-
-        //display the next option
-        colour = _get_menu_opt_colour(i, menu_state.main_menu_pos);
-        _draw_colour(main_win, colour, &y, &x, main_opt, 1, 0);
+        ret = ui_add_bind(&main_ui, win.body_start_y + i, win.body_start_x,
+                          win.body_sz_x, _bind_main_opt, NULL, i);
+        if (ret != 0) FATAL_FAIL(ERR_GENERIC)
     }
 
+    //windows with a "BACK" option
+    _layout_submenu(&roms_ui, ROMS, _bind_roms_row, _key_roms_row);
+    _layout_submenu(&info_ui, INFO, _bind_info_row, NULL);
+    _layout_submenu(&diag_ui, DIAG, _bind_diag_row, NULL);
+
+    //the ROMs window reports walks & the open folder in the row below "BACK"
+    ret = ui_add_bind(&roms_ui, win.body_start_y + 1, win.body_start_x,
+                      win.body_sz_x, _bind_roms_status, _key_roms_status, 0);
+    if (ret != 0) FATAL_FAIL(ERR_GENERIC)
+
+    //new nodes are all drawn, clear what the old layout left
+    rnd_erase(main_win);
+    rnd_erase(roms_win);
+    rnd_erase(info_win);
+    rnd_erase(diag_win);
+    shown_win = NULL;
+
     return;
 }
 
 
-//draw the roms menu
-static void _draw_roms_menu() {
+//scroll the ROMs menu so the selection stays in view
+static void _scroll_roms_to_pos() {
 
-    int y, x;
+    int rom_idx, submenu_sz;
 
-    int colour;
-    int range;
-    int scroll_i;
 
-    char * back_opt, * roms_opt;
+    rom_idx = menu_state.roms_menu_pos - ROMS_MENU_OPTS;
+    submenu_sz = _get_submenu_sz(&roms_menu_0, count_rom_items());
 
+    if (rom_idx < roms_menu_1.scroll)
+        roms_menu_1.scroll = (rom_idx < 0) ? 0 : rom_idx;
+    if (rom_idx >= roms_menu_1.scroll + submenu_sz)
+        roms_menu_1.scroll = rom_idx - submenu_sz + 1;
 
-    y = win.body_start_y;
-    x = win.body_start_x;
+    return;
+}
 
-    //fetch the "BACK" option
-    back_opt = cm_vct_get_p(&roms_menu_0.opts, 0);
-    if (back_opt == NULL) FATAL_FAIL(ERR_GENERIC)
 
-    //display the "BACK" option
-    colour = _get_menu_opt_colour(0, menu_state.roms_menu_pos);
-    _draw_colour(roms_win, colour, &y, &x, back_opt, 2, 0);
+//move & resize a window to the current layout
+static void _relayout_win(struct rnd_surface * window) {
 
+    rnd_move_surface(window, win.start_y, win.start_x, win.sz_y, win.sz_x);
+    return;
+}
 
-    //for each ROM menu option
-    range = _get_submenu_sz(&roms_menu_0, &roms_menu_1);
-    for (int i = 0; i < range; ++i) {
 
-        //get an i that accounts for menu scroll
-        scroll_i = roms_menu_1.scroll + i;
+/*
+ *  NOTE: The windows are kept & only moved, resized & repopulated.
+ */
 
-        //get the next option
-        roms_opt = cm_vct_get_p(&roms_menu_1.opts, scroll_i);
-        if (roms_opt == NULL) FATAL_FAIL(ERR_GENERIC)
+//lay the display out again after a terminal resize
+void disp_resize() {
 
-        //display the next option
-        colour = _get_roms_menu_opt_colour(
-                     scroll_i, menu_state.roms_menu_pos - 1);
-        _draw_colour(roms_win, colour, &y, &x, roms_opt, 1, 0);
+    //adopt the new terminal size, clearing the screen
+    rnd_resize();
+
+    //recompute the geometry & apply it to every window
+    _populate_dimensions();
+    _relayout_win(main_win);
+    _relayout_win(roms_win);
+    _relayout_win(info_win);
+    _relayout_win(diag_win);
+
+    //lines are formatted to the body width, rebuild them
+    _layout_wins();
+    _populate_main_menu();
+    if (menu_state.current_win == ROMS) {
+        _populate_roms_menu();
+        _scroll_roms_to_pos();
     }
+    if (menu_state.current_win == INFO) _populate_info_menu();
+    if (menu_state.current_win == DIAG) diag_menu_1.scroll = 0;
 
     return;
 }
 
 
-//draw the info menu
-static void _draw_info_menu() {
+//initialise the display on the selected render backend
+void init_disp() {
 
-    int y, x;
+    //initialise window arenas before menus are populated
+    init_arena(&main_arena, ARENA_BLK_SZ);
+    init_arena(&roms_arena, ARENA_BLK_SZ);
+    init_arena(&info_arena, ARENA_BLK_SZ);
+    init_arena(&diag_arena, ARENA_BLK_SZ);
 
-    int colour;
-    int range;
-    int scroll_i;
+    //initialise the render backend
+    _initialise();
+
+    //initialise windows & their draw-lists
+    _init_wins();
+    init_ui_list(&main_ui, WIN_BKGD);
+    init_ui_list(&roms_ui, WIN_BKGD);
+    init_ui_list(&info_ui, WIN_BKGD);
+    init_ui_list(&diag_ui, WIN_BKGD);
+    _layout_wins();
+
+    //update menu state
+    menu_state.current_win_ptr = main_win;
 
-    char * back_opt, * info_opt;
+    return;
+}
 
 
-    y = win.body_start_y;
-    x = win.body_start_x;
+//release the display
+void fini_disp() {
 
-    //fetch the "BACK" option
-    back_opt = cm_vct_get_p(&info_menu_0.opts, 0);
-    if (back_opt == NULL) FATAL_FAIL(ERR_GENERIC)
+    //release windows & their draw-lists
+    fini_ui_list(&diag_ui);
+    fini_ui_list(&info_ui);
+    fini_ui_list(&roms_ui);
+    fini_ui_list(&main_ui);
+    _fini_wins();
 
-    //display the "BACK" option
-    colour = _get_menu_opt_colour(0, menu_state.info_menu_pos);
-    _draw_colour(info_win, colour, &y, &x, back_opt, 2, 0);
+    //release menu lines & the window arenas holding them
+    _teardown_main_menu();
+    _teardown_rom_menu();
+    _teardown_info_menu();
+    disp_diag_exit();
 
+    fini_arena(&diag_arena);
+    fini_arena(&info_arena);
+    fini_arena(&roms_arena);
+    fini_arena(&main_arena);
 
-    //for each info menu data line
-    range = _get_submenu_sz(&info_menu_0, &info_menu_1);
-    for (int i = 0; i < range; ++i) {
+    //release the render backend
+    fini_render();
 
-        //reset x coordinate
-        x = win.body_start_x;
+    return;
+}
 
-        //get an i that accounts for menu scroll
-        scroll_i = info_menu_1.scroll + i;
 
-        //get the next data line
-        info_opt = cm_vct_get_p(&info_menu_1.opts, scroll_i);
-        if (info_opt == NULL) FATAL_FAIL(ERR_GENERIC)
+//populate diagnostics menu entries, keeping the scroll position
+static void _populate_diag_menu() {
 
-        //draw a regular line
-        if ((scroll_i < INFO_STATIC_LEN)
-            || ((scroll_i - INFO_STATIC_LEN) % (KEY_OPT_NUM + 2) <= 1)) {
+    int scroll, max_scroll;
+    int controller_count;
 
-            _draw_colour(info_win, BLACK_WHITE, &y, &x, info_opt, 1, 0);
+    struct js_info * js;
+    const struct diag_js * diag;
 
-        //print a controller key availability    
-        } else {
+    char line_buf[NAME_MAX], value_buf[KEY_DESC_LEN];
+
+
+    //reset the diagnostics menu options
+    scroll = diag_menu_1.scroll;
+    arena_reset(&diag_arena);
+    _construct_opts(&diag_menu_0, &diag_arena);
+    _construct_opts(&diag_menu_1, &diag_arena);
+
+    //populate the back option
+    _append_line(&diag_menu_0, "BACK", true);
+
+
+    //populate every present controller
+    controller_count = 0;
+    for (int i = 0; i < js_state.js.len; ++i) {
+
+        //skip this joystick if it isn't present
+        js = &((struct js_single_state *) cm_vct_get_p(&js_state.js, i))->info;
+        if (js->status == JS_ABSENT) continue;
+
+        //add a new line for subsequent controllers
+        if (controller_count != 0) _append_line(&diag_menu_1, "", false);
+        controller_count += 1;
+
+        snprintf(line_buf, win.body_sz_x, "CONTROLLER %d:", i + 1);
+        _append_line(&diag_menu_1, line_buf, true);
+
+        snprintf(line_buf, win.body_sz_x, "STATUS:           %s",
+                 js_status_str(js->status));
+        _append_line(&diag_menu_1, line_buf, false);
 
-        //draw a key state
-        _draw_substr_colour(info_win, BLACK_WHITE, &y, &x,
-                            info_opt, INFO_KEY_STATE_OFF, 0,
-                            INFO_KEY_STATE_OFF);
-
-            //display the `YES` or `NO` state in an appropriate colour
-            if (info_opt[INFO_KEY_STATE_OFF] == 'Y') {
-                _draw_colour(info_win, GREEN_WHITE, &y, &x,
-                             info_opt + INFO_KEY_STATE_OFF, 1, 0);
-            } else if (info_opt[INFO_KEY_STATE_OFF] == 'N') {
-                _draw_colour(info_win, RED_WHITE, &y, &x,
-                             info_opt + INFO_KEY_STATE_OFF, 1, 0);
+        //only controllers being read have statistics
+        diag = diag_get(i);
+        if (js->status != JS_OPEN && js->status != JS_DIAG) continue;
+
+        snprintf(line_buf, win.body_sz_x, "REPORT RATE:      %.1f HZ",
+                 (diag == NULL) ? 0.0 : diag->rate_hz);
+        _append_line(&diag_menu_1, line_buf, false);
+
+        snprintf(line_buf, win.body_sz_x, "JITTER:           %.2f MS",
+                 (diag == NULL) ? 0.0 : diag->jitter_ms);
+        _append_line(&diag_menu_1, line_buf, false);
+
+        //hold time of buttons & noise floor of axes the controller has
+        for (int j = 0; j < KEY_OPT_NUM; ++j) {
+
+            if (js->keys[j] == false) continue;
+
+            if (js_key_codes[j].type == EV_KEY) {
+                if (diag == NULL || diag->hold_us[j] == 0) {
+                    snprintf(value_buf, KEY_DESC_LEN, "-");
+                } else {
+                    snprintf(value_buf, KEY_DESC_LEN, "%.0f MS HELD",
+                             diag->hold_us[j] / 1000.0);
+                }
+            } else {
+                if (diag == NULL || js->abs_range[j] == 0) {
+                    snprintf(value_buf, KEY_DESC_LEN, "-");
+                } else {
+                    snprintf(value_buf, KEY_DESC_LEN, "%.1f%% NOISE",
+                             diag->noise_floor[j] * 100.0
+                             / js->abs_range[j]);
+                }
             }
+
+            _append_key_line(&diag_menu_1, j, value_buf, BLACK_WHITE);
         }
-        
-    } //end for each info menu line
+
+    } //end populate every present controller
+
+    if (controller_count == 0)
+        _append_line(&diag_menu_1, "NO CONTROLLERS", false);
+
+    //restore the scroll position, the line count may have changed
+    max_scroll = diag_menu_1.len
+                 - _get_submenu_sz(&diag_menu_0, diag_menu_1.len);
+    diag_menu_1.scroll = int_clamp(scroll, 0, max_scroll);
 
     return;
 }
 
 
-//redraw the screen
+//redraw the screen, drawing only what changed
 void redraw() {
 
-    werase(menu_state.current_win_ptr);
-    _draw_template(menu_state.current_win_ptr);
-    if (menu_state.current_win == MAIN) _draw_main_menu();
-    if (menu_state.current_win == ROMS) _draw_roms_menu();
-    if (menu_state.current_win == INFO) _draw_info_menu();
+    int ret;
+    struct ui_list * list;
+
+
+    switch (menu_state.current_win) {
+
+        case MAIN: list = &main_ui; break;
+        case ROMS: list = &roms_ui; break;
+        case INFO: list = &info_ui; break;
+
+        //statistics are live, rebuild the lines on every draw
+        case DIAG:
+            _populate_diag_menu();
+            list = &diag_ui;
+            break;
+
+        default: return;
+
+    } //end switch
+
+    //a window switched to is copied to the screen whole
+    if (menu_state.current_win_ptr != shown_win) {
+
+        rnd_touch(menu_state.current_win_ptr);
+        shown_win = menu_state.current_win_ptr;
+    }
+
+    ret = ui_render(list, menu_state.current_win_ptr);
+    if (ret == -1) FATAL_FAIL(ERR_GENERIC)
 
     return;
 }
 
 
-//refresh the active window
+//refresh the active window, recording the bytes written
 void disp_refresh() {
 
     int ret;
+    int64_t start;
+    uint64_t written;
+
 
+    start = rnd_written();
+
+    //show what changed on the window
+    ret = rnd_flush(menu_state.current_win_ptr);
+    if (ret != 0) FATAL_FAIL(ERR_GENERIC)
 
-    ret = wrefresh(menu_state.current_win_ptr);
-    if (ret == ERR) FATAL_FAIL(ERR_GENERIC)
+    //record the output of this frame, if the backend counts it
+    if (start == -1) return;
+    written = rnd_written() - start;
+    _out_stats.frames += 1;
+    _out_stats.frame_bytes += written;
+    if (written > _out_stats.max_frame_bytes)
+        _out_stats.max_frame_bytes = written;
 
     return;
 }
@@ -1033,12 +1427,12 @@ void disp_roms_exit() {
 //user presses the down key inside the ROMs window
 void disp_roms_down() {
 
-    int submenu_sz = _get_submenu_sz(&roms_menu_0, &roms_menu_1);
+    int submenu_sz = _get_submenu_sz(&roms_menu_0, count_rom_items());
 
 
     //if already reached the bottom, ignore
     if (menu_state.roms_menu_pos
-        == ROMS_MENU_OPTS + roms_menu_1.opts.len - 1) return;
+        == ROMS_MENU_OPTS + count_rom_items() - 1) return;
 
     //if already on the bottom of the menu, scroll the menu down
     if (menu_state.roms_menu_pos
@@ -1068,6 +1462,33 @@ void disp_roms_up() {
 }
 
 
+//user opens a folder inside the ROMs window
+void disp_roms_folder() {
+
+    //show the new folder from its top
+    roms_menu_1.scroll = 0;
+    _scroll_roms_to_pos();
+
+    return;
+}
+
+
+//the ROM list changed while the ROMs window is shown
+void disp_roms_update() {
+
+    int max_scroll;
+
+
+    //keep the rows in view filled, then the selection in view
+    max_scroll = count_rom_items()
+                 - _get_submenu_sz(&roms_menu_0, count_rom_items());
+    roms_menu_1.scroll = int_clamp(roms_menu_1.scroll, 0, max_scroll);
+    _scroll_roms_to_pos();
+
+    return;
+}
+
+
 //user presses the start/select/a key inside the ROMs window
 void disp_roms_select() {
 
@@ -1081,8 +1502,8 @@ void disp_roms_select() {
 //user enters the info window
 void disp_info_entry() {
 
-    //update info lines
-    update_roms();
+    //show the last snapshot now, fresh ones arrive as updates
+    stats_start();
     _populate_info_menu();
 
     //update state
@@ -1094,33 +1515,108 @@ void disp_info_entry() {
 
 //user exits the info window
 void disp_info_exit() {
+
+    stats_stop();
+    return;
+}
+
+
+//the info window's statistics changed
+void disp_info_update() {
+
+    int scroll, max_scroll;
+
+
+    if (menu_state.current_win != INFO) return;
+
+    //repopulate, keeping the scroll position
+    scroll = info_menu_1.scroll;
+    _populate_info_menu();
+
+    max_scroll = info_menu_1.len
+                 - _get_submenu_sz(&info_menu_0, info_menu_1.len);
+    info_menu_1.scroll = int_clamp(scroll, 0, max_scroll);
+
     return;
 }
 
 
 //user presses the down key inside the info window
-void disp_info_down() {
+bool disp_info_down() {
 
-    int submenu_sz = _get_submenu_sz(&info_menu_0, &info_menu_1);
+    int submenu_sz = _get_submenu_sz(&info_menu_0, info_menu_1.len);
 
 
     //if already reached the bottom, ignore
-    if (info_menu_1.scroll + submenu_sz == info_menu_1.opts.len)
-        return;
+    if (info_menu_1.scroll + submenu_sz == info_menu_1.len)
+        return false;
 
     //scroll the menu down
     info_menu_1.scroll += 1;
-    return;
+    return true;
 }
 
 
 //user presses the up key inside the info window
-void disp_info_up() {
+bool disp_info_up() {
 
     //if already reached the top, ignore
-    if (info_menu_1.scroll == 0) return;
+    if (info_menu_1.scroll == 0) return false;
 
     //scroll the menu up
     info_menu_1.scroll -= 1;
+    return true;
+}
+
+
+//user enters the diagnostics window
+void disp_diag_entry() {
+
+    //lines are populated when drawn
+    menu_state.current_win_ptr = diag_win;
+    diag_menu_1.scroll = 0;
+
+    return;
+}
+
+
+//user exits the diagnostics window
+void disp_diag_exit() {
+
+    _destruct_opts(&diag_menu_0);
+    _destruct_opts(&diag_menu_1);
+
     return;
 }
+
+
+//user presses the down key inside the diagnostics window
+bool disp_diag_down() {
+
+    int submenu_sz;
+
+
+    //lines are only known once drawn
+    if (diag_menu_1.is_init == false) return false;
+    submenu_sz = _get_submenu_sz(&diag_menu_0, diag_menu_1.len);
+
+    //if already reached the bottom, ignore
+    if (diag_menu_1.scroll + submenu_sz >= diag_menu_1.len)
+        return false;
+
+    //scroll the menu down
+    diag_menu_1.scroll += 1;
+    return true;
+}
+
+
+//user presses the up key inside the diagnostics window
+bool disp_diag_up() {
+
+    //if already reached the top, ignore
+    if (diag_menu_1.scroll == 0) return false;
+
+    //scroll the menu up
+    diag_menu_1.scroll -= 1;
+    return true;
+}
@@ -1,15 +1,15 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
-//external libraries
-#include <ncurses.h>
+//C standard library
+#include <stdbool.h>
 
 
 // -- [text] --
 
-//initialise & release ncurses global state
-void init_ncurses();
-void fini_ncurses();
+//initialise & release the display on the selected render backend
+void init_disp();
+void fini_disp();
 
 //redraw the display
 void redraw();
@@ -17,6 +17,9 @@ void redraw();
 //refresh the active windpw
 void disp_refresh();
 
+//lay the display out again after a terminal resize
+void disp_resize();
+
 //main window updates
 void disp_main_entry();
 void disp_main_exit();
@@ -29,11 +32,25 @@ void disp_roms_exit();
 void disp_roms_down();
 void disp_roms_up();
 
-//info window updates
+//ROMs window folder opened or list changed, called after `menu_state` is
+//updated
+void disp_roms_folder();
+void disp_roms_update();
+
+//info window updates, scrolling returns false if already at the end
 void disp_info_entry();
 void disp_info_exit();
-void disp_info_down();
-void disp_info_up();
+bool disp_info_down();
+bool disp_info_up();
+
+//info window statistics changed
+void disp_info_update();
+
+//diagnostics window updates, scrolling returns false if already at the end
+void disp_diag_entry();
+void disp_diag_exit();
+bool disp_diag_down();
+bool disp_diag_up();
 
 
 #endif
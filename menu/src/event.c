@@ -0,0 +1,312 @@
+//C standard library
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+//system headers
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+
+//local headers
+#include "common.h"
+#include "event.h"
+
+
+// -- [globals] --
+
+//signals routed through signal sources
+static sigset_t _ev_sigset;
+
+
+// -- [text] --
+
+//initialise an event loop
+void init_ev_loop(struct ev_loop * loop) {
+
+    memset(loop, 0, sizeof(*loop));
+
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epoll_fd < 0) FATAL_FAIL("Failed to create an epoll instance.")
+
+    return;
+}
+
+
+//release an event loop
+void fini_ev_loop(struct ev_loop * loop) {
+
+    close(loop->epoll_fd);
+    loop->epoll_fd = -1;
+
+    return;
+}
+
+
+/*
+ *  NOTE: A source's generation is stored alongside its fd in the epoll
+ *        event data. If a callback closes an fd & another callback in
+ *        the same batch reuses its number, the stale event is dropped
+ *        instead of being delivered to the new source.
+ */
+
+//add an event source
+int ev_add(struct ev_loop * loop, int fd,
+           uint32_t events, ev_cb cb, void * ctx) {
+
+    int ret;
+    struct epoll_event event;
+
+
+    if (fd < 0 || fd >= EV_MAX_FD) return -1;
+
+    //setup the source
+    loop->srcs[fd].cb  = cb;
+    loop->srcs[fd].ctx = ctx;
+    loop->srcs[fd].gen += 1;
+
+    //register the fd
+    event.events   = events;
+    event.data.u64 = ((uint64_t) loop->srcs[fd].gen << 32) | (uint32_t) fd;
+
+    ret = epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    if (ret != 0) {
+        loop->srcs[fd].cb = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+
+//change the events an event source is watched for
+int ev_mod(struct ev_loop * loop, int fd, uint32_t events) {
+
+    struct epoll_event event;
+
+
+    if (fd < 0 || fd >= EV_MAX_FD) return -1;
+
+    event.events   = events;
+    event.data.u64 = ((uint64_t) loop->srcs[fd].gen << 32) | (uint32_t) fd;
+
+    return epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, fd, &event);
+}
+
+
+//remove an event source
+void ev_del(struct ev_loop * loop, int fd) {
+
+    if (fd < 0 || fd >= EV_MAX_FD) return;
+
+    //closing the fd would also deregister it, this may fail harmlessly
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    loop->srcs[fd].cb  = NULL;
+    loop->srcs[fd].ctx = NULL;
+
+    return;
+}
+
+
+//set a callback to run after each batch of ready sources is dispatched
+void ev_set_batch_cb(struct ev_loop * loop, ev_batch_cb cb, void * ctx) {
+
+    loop->batch_cb  = cb;
+    loop->batch_ctx = ctx;
+
+    return;
+}
+
+
+//create a timer source, returns the timer's fd
+int ev_add_timer(struct ev_loop * loop, int interval_ms,
+                 ev_cb cb, void * ctx) {
+
+    int ret, fd;
+
+
+    fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) return -1;
+
+    ret = ev_set_timer(fd, interval_ms, interval_ms);
+    if (ret != 0) goto _ev_add_timer_cleanup;
+
+    ret = ev_add(loop, fd, EPOLLIN, cb, ctx);
+    if (ret != 0) goto _ev_add_timer_cleanup;
+
+    return fd;
+
+    _ev_add_timer_cleanup:
+    close(fd);
+    return -1;
+}
+
+
+//re-arm a timer source, 0 disarms
+int ev_set_timer(int fd, int first_ms, int interval_ms) {
+
+    struct itimerspec spec;
+
+
+    spec.it_value.tv_sec     = first_ms / 1000;
+    spec.it_value.tv_nsec    = (first_ms % 1000) * 1000000L;
+    spec.it_interval.tv_sec  = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (interval_ms % 1000) * 1000000L;
+
+    return timerfd_settime(fd, 0, &spec, NULL);
+}
+
+
+//acknowledge a timer expiry, returns the expiry count
+uint64_t ev_read_timer(int fd) {
+
+    ssize_t ret;
+    uint64_t expiries;
+
+
+    ret = read(fd, &expiries, sizeof(expiries));
+    if (ret != sizeof(expiries)) return 0;
+
+    return expiries;
+}
+
+
+//create a notification source, returns the eventfd
+int ev_add_notify(struct ev_loop * loop, ev_cb cb, void * ctx) {
+
+    int ret, fd;
+
+
+    fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) return -1;
+
+    ret = ev_add(loop, fd, EPOLLIN, cb, ctx);
+    if (ret != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+//wake a notification source, may be called from any thread
+void ev_notify(int fd) {
+
+    ssize_t ret;
+    uint64_t one = 1;
+
+
+    //a full counter already guarantees a wakeup, failure is harmless
+    ret = write(fd, &one, sizeof(one));
+    (void) ret;
+
+    return;
+}
+
+
+//acknowledge pending notifications, returns their count
+uint64_t ev_read_notify(int fd) {
+
+    ssize_t ret;
+    uint64_t count;
+
+
+    ret = read(fd, &count, sizeof(count));
+    if (ret != sizeof(count)) return 0;
+
+    return count;
+}
+
+
+//block signals & create a signal source, returns the signal fd
+int ev_add_signals(struct ev_loop * loop, const sigset_t * set,
+                   ev_cb cb, void * ctx) {
+
+    int ret, fd;
+
+
+    //signals must be blocked to be delivered through the fd
+    for (int sig = 1; sig < NSIG; ++sig) {
+        if (sigismember(set, sig) == 1) sigaddset(&_ev_sigset, sig);
+    }
+    ev_block_signals();
+
+    fd = signalfd(-1, set, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0) return -1;
+
+    ret = ev_add(loop, fd, EPOLLIN, cb, ctx);
+    if (ret != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+//unblock signals handled by signal sources
+void ev_unblock_signals() {
+
+    sigprocmask(SIG_UNBLOCK, &_ev_sigset, NULL);
+    return;
+}
+
+
+//re-block signals handled by signal sources
+void ev_block_signals() {
+
+    sigprocmask(SIG_BLOCK, &_ev_sigset, NULL);
+    return;
+}
+
+
+//dispatch events until the loop is stopped
+void ev_run(struct ev_loop * loop) {
+
+    int count, fd;
+    uint32_t gen;
+    struct ev_src * src;
+    struct epoll_event events[EV_BATCH_SZ];
+
+
+    loop->is_running = true;
+    while (loop->is_running == true) {
+
+        //sleep until at least one source is ready
+        count = epoll_wait(loop->epoll_fd, events, EV_BATCH_SZ, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            FATAL_FAIL("Failed to wait for events.")
+        }
+
+        //dispatch ready sources
+        for (int i = 0; i < count; ++i) {
+
+            fd  = (int) (events[i].data.u64 & 0xffffffff);
+            gen = (uint32_t) (events[i].data.u64 >> 32);
+            src = &loop->srcs[fd];
+
+            //skip sources removed by an earlier callback
+            if (src->cb == NULL || src->gen != gen) continue;
+            src->cb(fd, events[i].events, src->ctx);
+        }
+
+        //let the owner act on everything this batch produced
+        if (loop->batch_cb != NULL) loop->batch_cb(loop->batch_ctx);
+    }
+
+    return;
+}
+
+
+//stop the loop after the current batch
+void ev_stop(struct ev_loop * loop) {
+
+    loop->is_running = false;
+    return;
+}
@@ -0,0 +1,97 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+//C standard library
+#include <stdbool.h>
+#include <stdint.h>
+
+//system headers
+#include <signal.h>
+
+
+// -- [macros] --
+
+//highest file descriptor an event loop can watch
+#define EV_MAX_FD 1024
+
+//maximum number of ready sources returned by a single wait
+#define EV_BATCH_SZ 16
+
+
+// -- [data] --
+
+//event source callback
+typedef void (* ev_cb)(int fd, uint32_t events, void * ctx);
+
+//end of batch callback
+typedef void (* ev_batch_cb)(void * ctx);
+
+//event source
+struct ev_src {
+
+    ev_cb cb;
+    void * ctx;
+    uint32_t gen;
+};
+
+//epoll-based event loop
+struct ev_loop {
+
+    int epoll_fd;
+    bool is_running;
+
+    ev_batch_cb batch_cb;
+    void * batch_ctx;
+
+    struct ev_src srcs[EV_MAX_FD];
+};
+
+
+// -- [text] --
+
+//initialise & release an event loop
+void init_ev_loop(struct ev_loop * loop);
+void fini_ev_loop(struct ev_loop * loop);
+
+//add, change & remove an event source
+int ev_add(struct ev_loop * loop, int fd,
+           uint32_t events, ev_cb cb, void * ctx);
+int ev_mod(struct ev_loop * loop, int fd, uint32_t events);
+void ev_del(struct ev_loop * loop, int fd);
+
+//set a callback to run after each batch of ready sources is dispatched
+void ev_set_batch_cb(struct ev_loop * loop, ev_batch_cb cb, void * ctx);
+
+//create a timer source, returns the timer's fd
+int ev_add_timer(struct ev_loop * loop, int interval_ms,
+                 ev_cb cb, void * ctx);
+
+//re-arm a timer source, 0 disarms
+int ev_set_timer(int fd, int first_ms, int interval_ms);
+
+//acknowledge a timer expiry, returns the expiry count
+uint64_t ev_read_timer(int fd);
+
+//create a notification source, returns the eventfd
+int ev_add_notify(struct ev_loop * loop, ev_cb cb, void * ctx);
+
+//wake a notification source, may be called from any thread
+void ev_notify(int fd);
+
+//acknowledge pending notifications, returns their count
+uint64_t ev_read_notify(int fd);
+
+//block signals & create a signal source, returns the signal fd
+int ev_add_signals(struct ev_loop * loop, const sigset_t * set,
+                   ev_cb cb, void * ctx);
+
+//unblock & re-block signals handled by signal sources (around execve)
+void ev_unblock_signals();
+void ev_block_signals();
+
+//dispatch events until the loop is stopped
+void ev_run(struct ev_loop * loop);
+void ev_stop(struct ev_loop * loop);
+
+
+#endif
@@ -1,11 +1,18 @@
 //C standard library
+#include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
+#include <stdatomic.h>
+#include <time.h>
 
 //system headers
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
 
 //kernel headers
 #include <linux/input.h>
@@ -14,10 +21,111 @@
 //external libraries
 #include <libudev.h>
 #include <libevdev-1.0/libevdev/libevdev.h>
+#include <cmore.h>
 
 //local headers
 #include "common.h"
+#include "caps.h"
 #include "input.h"
+#include "event.h"
+#include "ring.h"
+#include "latency.h"
+
+
+// -- [data] --
+
+//joystick:event device pair, keyed by the number of their parent device
+struct js_node {
+
+    int parent_num;
+    bool is_dirty;
+    struct caps_id caps_id;
+
+    //joystick device & its slot in the device table, -1 if unassigned
+    int js_idx;
+    dev_t js_devnum;
+    char vendor[JS_NAME_SZ];
+    char model[JS_NAME_SZ];
+
+    //event device
+    dev_t evdev_devnum;
+    char evdev_path[JS_DEVFS_SZ];
+};
+
+
+//ring of inputs read from a joystick but not yet published, only
+//`committed` inputs up to the last SYN_REPORT form complete frames
+struct js_queue {
+
+    int head;
+    int len;
+    int committed;
+    struct input_event events[JS_QUEUE_LEN];
+};
+
+
+//joystick device state, owned by the device thread
+struct js_dev {
+
+    char evdev_path[JS_DEVFS_SZ];
+    char vendor[JS_NAME_SZ];
+    char model[JS_NAME_SZ];
+
+    dev_t evdev_devnum;
+    struct caps_id caps_id;
+
+    enum js_status status;
+
+    //devnum of the joystick device that owns this slot
+    dev_t js_devnum;
+
+    bool is_present;
+    bool is_replaced;
+    bool is_good;
+    bool is_probed;
+    bool input_failed;
+    bool is_syncing;
+    bool is_backlogged;
+
+    //SYN_DROPPED overflows, each losing one or more frames
+    unsigned long dropped_frames;
+
+    //consecutive failures & the monotonic time of the next retry
+    int fail_count;
+    uint64_t retry_ms;
+
+    int evdev_fd;
+    bool keys[KEY_OPT_NUM];
+    int abs_range[KEY_OPT_NUM];
+    struct libevdev * evdev;
+
+    struct js_queue queue;
+
+    //last state published to the menu
+    struct js_info published;
+};
+
+
+//device thread to menu message types
+enum js_msg_type {
+    JS_MSG_INPUT,
+    JS_MSG_INFO
+};
+
+//device thread to menu message
+struct js_msg {
+
+    enum js_msg_type type;
+    int idx;
+
+    //monotonic time an input was published at
+    uint64_t publish_us;
+
+    union {
+        struct input_event in_event;
+        struct js_info info;
+    };
+};
 
 
 // -- [globals] --
@@ -25,25 +133,59 @@
 //global joystick state
 struct js_state js_state;
 
-//global joystick device pathnames
-const char * _js_path[4] = {
-    JS0_DEVFS_PATH,
-    JS1_DEVFS_PATH,
-    JS2_DEVFS_PATH,
-    JS3_DEVFS_PATH
-};
+//joystick device table, slots are reused but never removed
+static cm_vct _js_devs; //type: struct js_dev
 
 //global udev context
 struct udev * _udev_ctx;
 
+//input subsystem hotplug monitor
+static struct udev_monitor * _udev_mon;
+
+//index of joystick:event device pairs
+static cm_vct _js_index; //type: struct js_node
+
+//device thread & the event loop it watches joysticks from
+static pthread_t _js_thread;
+static struct ev_loop _js_loop;
+
+//device thread stop & resume requests
+static int _js_stop_fd   = -1;
+static int _js_resume_fd = -1;
+
+//messages for the menu, the menu's loop & its notification source
+static struct spsc_ring _js_ring;
+static struct ev_loop * _js_menu_loop;
+static int _js_ready_fd = -1;
+
+//set by the device thread when the ring filled up
+static atomic_bool _js_ring_stalled;
+
+//set by the menu while diagnostics are shown, & its notification source
+static atomic_bool _js_diag;
+static int _js_diag_fd = -1;
+
+//joystick retry & rescan timer
+static int _js_timer_fd = -1;
+
+//menu's receiver of joystick state changes
+static js_change_cb _js_change_cb;
+
 
 // -- [text] --
 
 //initialise global udev context
 void init_udev() {
 
+    int ret;
+
+
     _udev_ctx = udev_new();
     if (_udev_ctx == NULL) FATAL_FAIL("Failed to create a udev context.");
+
+    ret = cm_new_vct(&_js_index, sizeof(struct js_node));
+    if (ret != 0) FATAL_FAIL("Failed to initialise the joystick index.");
+
     return;
 }
 
@@ -51,21 +193,13 @@ void init_udev() {
 //release global udev context
 void fini_udev() {
 
+    if (_udev_mon != NULL) udev_monitor_unref(_udev_mon);
+    cm_del_vct(&_js_index);
     udev_unref(_udev_ctx);
     return;
 }
 
 
-//initialise global joystick state
-void init_js() {
-
-    js_state.have_main_js = true;
-    js_state.main_js_idx  = 0;
-
-    return;
-}
-
-
 /*
  *  NOTE: Calls to libudev often allocate resources. Almost every libudev
  *        call can fail. To exhaustively handle all fail cases without 
@@ -78,508 +212,1257 @@ void init_js() {
 //joystick:event device pair enumeration - error handling macros
 #define _IF_NULL_ERR_JS_NO_CLEANUP(ptr) \
     if (ptr == NULL) { \
-        subsys_state.udev_good = false; \
+        atomic_store(&subsys_state.udev_good, false); \
         goto _no_cleanup; \
     }
 
 #define _IF_NULL_ERR_JS_ENUM(ptr) \
     if (ptr == NULL) { \
-        subsys_state.udev_good = false; \
+        atomic_store(&subsys_state.udev_good, false); \
         goto _js_enum_cleanup; \
     }
     
 #define _IF_NEG_ERR_JS_ENUM(val) \
     if (val < 0) { \
-        subsys_state.udev_good = false; \
+        atomic_store(&subsys_state.udev_good, false); \
         goto _js_enum_cleanup; \
     }
 
-#define _IF_NULL_ERR_JS_DEVICE(ptr) \
+#define _IF_NULL_ERR_INDEX(ptr) \
     if (ptr == NULL) { \
-        subsys_state.udev_good = false; \
-        goto _js_device_cleanup; \
+        atomic_store(&subsys_state.udev_good, false); \
+        return false; \
     }
-    
-#define _IF_NEG_ERR_JS_DEVICE(val) \
-    if (val < 0) { \
-        subsys_state.udev_good = false; \
-        goto _js_device_cleanup; \
+
+//joystick:event device pair enumeration - helper macros
+#define _COPY_STR_JS(dst, str, sz) \
+    { len = strnlen(str, sz - 1); \
+      memcpy(dst, str, len); \
+      dst[len] = '\0'; }
+
+
+//binary search the index for a parent, returns its position or insert point
+static int _find_js_node(int parent_num, bool * found) {
+
+    int low, high, mid;
+    struct js_node * node;
+
+
+    low  = 0;
+    high = _js_index.len - 1;
+
+    while (low <= high) {
+
+        mid  = low + ((high - low) / 2);
+        node = cm_vct_get_p(&_js_index, mid);
+
+        if (node->parent_num == parent_num) {
+            *found = true;
+            return mid;
+        }
+
+        if (node->parent_num < parent_num) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
     }
 
-#define _IF_NULL_ERR_PARENT_ENUM(ptr) \
-    if (ptr == NULL) { \
-        subsys_state.udev_good = false; \
-        goto _parent_enum_cleanup; \
+    *found = false;
+    return low;
+}
+
+
+//get the node of a parent input device, creating it if necessary
+static struct js_node * _get_js_node(int parent_num) {
+
+    int ret, pos;
+    bool found;
+
+    struct js_node new_node;
+
+
+    pos = _find_js_node(parent_num, &found);
+    if (found == true) return cm_vct_get_p(&_js_index, pos);
+
+    //insert a new empty node, keeping the index sorted
+    memset(&new_node, 0, sizeof(new_node));
+    new_node.parent_num = parent_num;
+    new_node.js_idx     = -1;
+
+    ret = cm_vct_ins(&_js_index, pos, &new_node);
+    if (ret != 0) return NULL;
+
+    return cm_vct_get_p(&_js_index, pos);
+}
+
+
+//read a hexadecimal identity attribute of an input device
+static uint16_t _get_id_attr(struct udev_device * device, const char * attr) {
+
+    const char * str;
+
+
+    str = udev_device_get_sysattr_value(device, attr);
+    if (str == NULL) return 0;
+
+    return (uint16_t) strtoul(str, NULL, 16);
+}
+
+
+//add or update a device in the index, returns true if it was indexed
+static bool _index_js_device(struct udev_device * device) {
+
+    bool is_js;
+    size_t len;
+
+    const char * str;
+    const char * devfs_path, * sysname;
+
+    struct js_node * node;
+    struct udev_device * parent_device;
+
+
+    devfs_path = udev_device_get_devnode(device);
+    sysname    = udev_device_get_sysname(device);
+    if (devfs_path == NULL || sysname == NULL) //not an error
+        return false;
+
+    //only joystick & event devices are indexed
+    is_js = (strncmp(sysname, "js", 2) == 0);
+    if (is_js == false && strncmp(sysname, "event", 5) != 0) return false;
+
+    //find the node shared with sibling devices
+    parent_device = udev_device_get_parent_with_subsystem_devtype(
+                        device, "input", NULL);
+    _IF_NULL_ERR_INDEX(parent_device)
+
+    str = udev_device_get_sysnum(parent_device);
+    _IF_NULL_ERR_INDEX(str)
+
+    node = _get_js_node(atoi(str));
+    _IF_NULL_ERR_INDEX(node)
+
+    //save the identity the capability cache is keyed by
+    node->caps_id.bustype = _get_id_attr(parent_device, "id/bustype");
+    node->caps_id.vendor  = _get_id_attr(parent_device, "id/vendor");
+    node->caps_id.product = _get_id_attr(parent_device, "id/product");
+    node->caps_id.version = _get_id_attr(parent_device, "id/version");
+
+    //save a joystick device & cache its vendor and model
+    if (is_js == true) {
+
+        node->js_devnum = udev_device_get_devnum(device);
+
+        str = udev_device_get_property_value(device, "ID_VENDOR");
+        if (str == NULL) str = "Generic vendor";
+        _COPY_STR_JS(node->vendor, str, JS_NAME_SZ)
+
+        str = udev_device_get_property_value(device, "ID_MODEL");
+        if (str == NULL) str = "Generic controller";
+        _COPY_STR_JS(node->model, str, JS_NAME_SZ)
+
+    //save an event device
+    } else {
+
+        node->evdev_devnum = udev_device_get_devnum(device);
+        _COPY_STR_JS(node->evdev_path, devfs_path, JS_DEVFS_SZ)
     }
-    
-#define _IF_NEG_ERR_PARENT_ENUM(val) \
-    if (val < 0) { \
-        subsys_state.udev_good = false; \
-        goto _parent_enum_cleanup; \
+
+    node->is_dirty = true;
+    return true;
+}
+
+
+//remove a device from the index, returns true if it was indexed
+static bool _unindex_js_device(dev_t devnum) {
+
+    struct js_node * node;
+
+
+    for (int i = 0; i < _js_index.len; ++i) {
+
+        node = cm_vct_get_p(&_js_index, i);
+
+        if (node->js_devnum != 0 && node->js_devnum == devnum) {
+            node->js_idx    = -1;
+            node->js_devnum = 0;
+
+        } else if (node->evdev_path[0] != '\0'
+                   && node->evdev_devnum == devnum) {
+            node->evdev_path[0] = '\0';
+            node->evdev_devnum  = 0;
+
+        } else { continue; }
+
+        node->is_dirty = true;
+        return true;
     }
 
-#define _IF_NULL_ERR_EVENT_DEVICE(ptr) \
-    if (ptr == NULL) { \
-        subsys_state.udev_good = false; \
-        goto _event_cleanup; \
+    return false;
+}
+
+
+//get a joystick device table slot
+static struct js_dev * _get_js_dev(int idx) {
+
+    return cm_vct_get_p(&_js_devs, idx);
+}
+
+
+//find the slot of a joystick device, claiming a free or new slot for it
+static int _claim_js_slot(dev_t js_devnum) {
+
+    int ret, free_idx;
+    struct js_dev * js, new_js;
+
+
+    //a rescan finds joysticks in the slots they already own
+    free_idx = -1;
+    for (int i = 0; i < _js_devs.len; ++i) {
+
+        js = _get_js_dev(i);
+        if (js->js_devnum == js_devnum) return i;
+
+        if (free_idx < 0 && js->js_devnum == 0 && js->status == JS_ABSENT)
+            free_idx = i;
     }
-    
-#define _IF_NEG_ERR_EVENT_DEVICE(val) \
-    if (val < 0) { \
-        subsys_state.udev_good = false; \
-        goto _event_cleanup; \
+
+    //grow the table only if every slot is in use
+    if (free_idx < 0) {
+
+        memset(&new_js, 0, sizeof(new_js));
+        new_js.evdev_fd = -1;
+
+        ret = cm_vct_apd(&_js_devs, &new_js);
+        if (ret != 0) return -1;
+        free_idx = _js_devs.len - 1;
     }
 
-//joystick:event device pair enumeration - helper macros
-#define _COPY_STR_JS(str, field) \
-    { len = strnlen(str, PATH_MAX - 1); \
-      strncpy(js_state.js[i].field, str, len + 1); \
-      js_state.js[i].field[len] = '\0'; }
+    _get_js_dev(free_idx)->js_devnum = js_devnum;
+    return free_idx;
+}
+
+
+//synchronise joystick states with the index
+static void _sync_js_slots() {
+
+    struct js_node * node;
+    struct js_dev * js;
+
+
+    //joysticks without a node are gone
+    for (int i = 0; i < _js_devs.len; ++i)
+        _get_js_dev(i)->is_present = false;
+
+    for (int i = 0; i < _js_index.len; ++i) {
+
+        node = cm_vct_get_p(&_js_index, i);
+
+        //drop nodes left without any devices
+        if (node->js_devnum == 0 && node->evdev_path[0] == '\0') {
+            cm_vct_rmv(&_js_index, i);
+            --i;
+            continue;
+        }
+
+        //skip event devices that don't belong to a joystick
+        if (node->js_devnum == 0) {
+            node->is_dirty = false;
+            continue;
+        }
+
+        //match the joystick to its slot by devnum
+        if (node->js_idx < 0) {
+            node->js_idx = _claim_js_slot(node->js_devnum);
+            if (node->js_idx < 0) {
+                atomic_store(&subsys_state.udev_good, false);
+                continue;
+            }
+            node->is_dirty = true;
+        }
+
+        js = _get_js_dev(node->js_idx);
+        js->is_present = true;
+
+        //copy cached strings only if this pair changed
+        if (node->is_dirty == false) continue;
+
+        //a different event device must be re-opened & re-probed
+        if (strncmp(js->evdev_path, node->evdev_path, JS_DEVFS_SZ) != 0) {
+            js->is_probed   = false;
+            js->is_replaced = true;
+        }
+
+        memcpy(js->evdev_path, node->evdev_path, JS_DEVFS_SZ);
+        js->evdev_devnum = node->evdev_devnum;
+        js->caps_id      = node->caps_id;
+        memcpy(js->vendor, node->vendor, JS_NAME_SZ);
+        memcpy(js->model, node->model, JS_NAME_SZ);
+        node->is_dirty = false;
+    }
+
+    return;
+}
 
 
 //joystick:event device pair enumeration - function
 static void _update_js_devices() {
 
     int ret;
-    size_t len;
-    bool do_break;
 
-    const char * str;
-    
-    const char * devfs_path, * js_devfs_path;
-    const char * sysfs_path, * parent_sysfs_path;
+    const char * sysfs_path;
 
-    struct udev_device * js_device, * parent_device, * event_device;
-    struct udev_enumerate * js_enumerate, * parent_enumerate;
-    
-    struct udev_list_entry * js_devices, * js_device_entry;
-    struct udev_list_entry * parent_devices, * parent_device_entry;
+    struct udev_device * device;
+    struct udev_enumerate * enumerate;
+    struct udev_list_entry * devices, * device_entry;
 
 
-    //cleanup joystick states
-    for (int i = 0; i < 4; ++i) { js_state.js[i].is_present = false; }
+    //rebuild the index from scratch
+    cm_vct_emp(&_js_index);
 
-    //perform a joystick device scan
-    js_enumerate = udev_enumerate_new(_udev_ctx);
-    _IF_NULL_ERR_JS_NO_CLEANUP(js_enumerate)
+    //perform a single input device scan
+    enumerate = udev_enumerate_new(_udev_ctx);
+    _IF_NULL_ERR_JS_NO_CLEANUP(enumerate)
 
-    ret = udev_enumerate_add_match_subsystem(js_enumerate, "input");
+    ret = udev_enumerate_add_match_subsystem(enumerate, "input");
     _IF_NEG_ERR_JS_ENUM(ret)
 
-    ret = udev_enumerate_scan_devices(js_enumerate);
+    ret = udev_enumerate_scan_devices(enumerate);
     _IF_NEG_ERR_JS_ENUM(ret)
 
-    js_devices = udev_enumerate_get_list_entry(js_enumerate);
-    _IF_NULL_ERR_JS_ENUM(js_devices)
+    devices = udev_enumerate_get_list_entry(enumerate);
+    _IF_NULL_ERR_JS_ENUM(devices)
 
 
-    //iterate over discovered devices 
-    udev_list_entry_foreach(js_device_entry, js_devices) {
+    //index every joystick & event device, pairing them by parent
+    udev_list_entry_foreach(device_entry, devices) {
 
-        //find the devfs path of this device
-        sysfs_path = udev_list_entry_get_name(js_device_entry);
-        _IF_NULL_ERR_JS_ENUM(js_devices)
+        sysfs_path = udev_list_entry_get_name(device_entry);
+        _IF_NULL_ERR_JS_ENUM(sysfs_path)
 
-        js_device = udev_device_new_from_syspath(_udev_ctx, sysfs_path);
-        _IF_NULL_ERR_JS_ENUM(js_devices)
+        device = udev_device_new_from_syspath(_udev_ctx, sysfs_path);
+        _IF_NULL_ERR_JS_ENUM(device)
 
-        js_devfs_path = udev_device_get_devnode(js_device);
-        if (js_devfs_path == NULL) //not an error
-            goto _js_device_cleanup;
+        _index_js_device(device);
+        udev_device_unref(device);
 
-        //if this is one of the four joysticks
-        for (int i = 0; i < 4; ++i) {
-            if (strncmp(js_devfs_path, _js_path[i],
-                        strnlen(js_devfs_path, PATH_MAX)) != 0) continue;
+    } //end for-each (device)
 
-            //locate the corresponding event
-            parent_device = udev_device_get_parent_with_subsystem_devtype(
-                               js_device, "input", NULL);
-            _IF_NULL_ERR_JS_DEVICE(parent_device)
+    _js_enum_cleanup:
+    udev_enumerate_unref(enumerate);
 
-            parent_sysfs_path = udev_device_get_syspath(parent_device);
-            _IF_NULL_ERR_JS_DEVICE(parent_sysfs_path)
+    _no_cleanup:
+    _sync_js_slots();
+    return;
+}
 
-            parent_enumerate = udev_enumerate_new(_udev_ctx);
-            _IF_NULL_ERR_JS_DEVICE(parent_enumerate)
 
-            ret = udev_enumerate_add_match_subsystem(
-                      parent_enumerate, "input");
-            _IF_NEG_ERR_PARENT_ENUM(ret)
+//apply a single hotplug event, returns true if the index changed
+static bool _apply_js_hotplug(struct udev_device * device) {
 
-            ret = udev_enumerate_add_match_property(
-                parent_enumerate, "ID_INPUT", "1");
-            _IF_NEG_ERR_PARENT_ENUM(ret)
+    const char * action;
 
-            ret = udev_enumerate_scan_devices(parent_enumerate);
-            _IF_NEG_ERR_PARENT_ENUM(ret)
 
-            parent_devices = udev_enumerate_get_list_entry(
-                                  parent_enumerate);
-            _IF_NULL_ERR_PARENT_ENUM(parent_devices)
+    action = udev_device_get_action(device);
+    if (action == NULL) return false;
 
-            do_break = false;
-            udev_list_entry_foreach(parent_device_entry, parent_devices) {
+    //removed devices no longer have a parent, match them by devnum
+    if (strncmp(action, "remove", NAME_MAX) == 0)
+        return _unindex_js_device(udev_device_get_devnum(device));
 
-                sysfs_path
-                    = udev_list_entry_get_name(parent_device_entry);
-                _IF_NULL_ERR_PARENT_ENUM(sysfs_path)
+    return _index_js_device(device);
+}
 
-                event_device = udev_device_new_from_syspath(
-                                   _udev_ctx, sysfs_path);
-                _IF_NULL_ERR_PARENT_ENUM(event_device)
 
-                sysfs_path = udev_device_get_syspath(
-                                 udev_device_get_parent(event_device));
-                _IF_NULL_ERR_EVENT_DEVICE(sysfs_path)
+//linux event type & code of each menu key
+const struct js_key_code js_key_codes[KEY_OPT_NUM] = {
+    [MENU_KEY_SOUTH]  = {EV_KEY, BTN_SOUTH},
+    [MENU_KEY_EAST]   = {EV_KEY, BTN_EAST},
+    [MENU_KEY_NORTH]  = {EV_KEY, BTN_NORTH},
+    [MENU_KEY_WEST]   = {EV_KEY, BTN_WEST},
+    [MENU_KEY_TL]     = {EV_KEY, BTN_TL},
+    [MENU_KEY_TR]     = {EV_KEY, BTN_TR},
+    [MENU_KEY_SELECT] = {EV_KEY, BTN_SELECT},
+    [MENU_KEY_START]  = {EV_KEY, BTN_START},
+    [MENU_KEY_DPAD_X] = {EV_ABS, ABS_HAT0X},
+    [MENU_KEY_DPAD_Y] = {EV_ABS, ABS_HAT0Y},
+    [MENU_KEY_ABS_X]  = {EV_ABS, ABS_X},
+    [MENU_KEY_ABS_Y]  = {EV_ABS, ABS_Y}
+};
 
-                //if this event device shares a parent with the js device
-                if (strncmp(sysfs_path, parent_sysfs_path, PATH_MAX) == 0) {
 
-                    devfs_path = udev_device_get_devnode(event_device);
-                    if (devfs_path == NULL) //not an error
-                        goto _event_cleanup;
+//test a bit of an EVIOCGBIT bitmap
+#define _TEST_BIT(bits, bit) \
+    ((bits[(bit) / (sizeof(long) * 8)] >> ((bit) % (sizeof(long) * 8))) & 1)
 
-                    
-                    if (strstr(devfs_path, "event") != NULL) {
-                        _COPY_STR_JS(devfs_path, evdev_path)
-                        do_break = true;
-                    }
-                }
 
-                _event_cleanup:
-                udev_device_unref(event_device);
-                if (do_break == true) break;
-                
-            } //end for-each (parent)
+//read the keymap of an open event device with two bitmap queries
+static int _probe_js_keys(int fd, bool * keys) {
 
-            //save vendor
-            str = udev_device_get_property_value(js_device, "ID_VENDOR");
-            if (str != NULL) _COPY_STR_JS(str, vendor)
-            else _COPY_STR_JS("Generic vendor", vendor);
+    int ret;
+    unsigned long key_bits[(KEY_MAX / (sizeof(long) * 8)) + 1] = {0};
+    unsigned long abs_bits[(ABS_MAX / (sizeof(long) * 8)) + 1] = {0};
 
-            //save model
-            str = udev_device_get_property_value(js_device, "ID_MODEL");
-            if (str != NULL) _COPY_STR_JS(str, model)
-            else _COPY_STR_JS("Generic controller", model);
 
-            //mark joystick as present & good
-            js_state.js[i].is_present = true;
+    ret = ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key_bits)), key_bits);
+    if (ret < 0) return -1;
 
+    ret = ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(abs_bits)), abs_bits);
+    if (ret < 0) return -1;
 
-            _parent_enum_cleanup:
-            udev_enumerate_unref(parent_enumerate);
+    for (int i = 0; i < KEY_OPT_NUM; ++i) {
+        keys[i] = (js_key_codes[i].type == EV_KEY)
+                      ? _TEST_BIT(key_bits, js_key_codes[i].code)
+                      : _TEST_BIT(abs_bits, js_key_codes[i].code);
+    }
 
-        } //end if four joysticks
-        
+    return 0;
+}
 
-        //cleanup for this iteration
-        _js_device_cleanup:
-        udev_device_unref(js_device);
 
-    } //end for-each (joystick)
+//check if a joystick has all required buttons & axes
+static bool _is_js_good(int idx) {
 
-    _js_enum_cleanup:
-    udev_enumerate_unref(js_enumerate);
+    for (int i = 0; i < KEY_REQ_NUM; ++i) {
+        if (_get_js_dev(idx)->keys[i] == false) return false;
+    }
 
-    _no_cleanup:
+    return true;
+}
+
+
+//step joystick slots on the next loop iteration
+static void _schedule_js_step() {
+
+    ev_set_timer(_js_timer_fd, 1, 0);
     return;
 }
 
 
-//linux-to-macro button mapping for keys
-static inline int _lookup_key(int keycode) {
+/*
+ *  NOTE: When the kernel's evdev buffer overflows it discards queued
+ *        events & reports SYN_DROPPED. Events since the last complete
+ *        frame are then meaningless & are discarded as well. libevdev
+ *        switches to sync mode, where it replays the difference between
+ *        the last known & the current device state as regular events
+ *        followed by a SYN_REPORT. Normal reading resumes once the
+ *        replay returns -EAGAIN.
+ */
+
+//read a joystick's pending inputs until it runs dry or its queue fills
+static void _drain_js(int idx) {
+
+    int ret;
+    unsigned int flags;
 
-    switch (keycode) {
+    struct input_event * in_event;
+    struct js_dev * js = _get_js_dev(idx);
+    struct js_queue * queue = &js->queue;
 
-        case BTN_SOUTH:
-            return MENU_KEY_SOUTH;
 
-        case BTN_EAST:
-            return MENU_KEY_EAST;
+    //resume watching a joystick whose queue filled up earlier
+    if (js->is_backlogged == true) {
+        ev_mod(&_js_loop, js->evdev_fd, EPOLLIN);
+        js->is_backlogged = false;
+    }
 
-        case BTN_NORTH:
-            return MENU_KEY_NORTH;
+    while (true) {
 
-        case BTN_WEST:
-            return MENU_KEY_WEST;
+        //leave the remaining inputs for after this queue is published,
+        //the device is not watched until then
+        if (queue->len == JS_QUEUE_LEN) {
+            ev_mod(&_js_loop, js->evdev_fd, 0);
+            js->is_backlogged = true;
+            break;
+        }
 
-        case BTN_TL:
-            return MENU_KEY_TL;
+        flags = (js->is_syncing == true)
+                    ? LIBEVDEV_READ_FLAG_SYNC : LIBEVDEV_READ_FLAG_NORMAL;
 
-        case BTN_TR:
-            return MENU_KEY_TR;
+        in_event = &queue->events[(queue->head + queue->len) % JS_QUEUE_LEN];
+        ret = libevdev_next_event(js->evdev, flags, in_event);
 
-        case BTN_SELECT:
-            return MENU_KEY_SELECT;
+        //the device overflowed, discard the partial frame & start a replay
+        if (ret == LIBEVDEV_READ_STATUS_SYNC && js->is_syncing == false) {
+            queue->len = queue->committed;
+            js->is_syncing = true;
+            js->dropped_frames += 1;
+            continue;
+        }
 
-        case BTN_START:
-            return MENU_KEY_START;
+        //the replay finished, resume normal reading
+        if (ret == -EAGAIN && js->is_syncing == true) {
+            js->is_syncing = false;
+            continue;
+        }
 
-        default:
-            return -1;
+        if (ret == -EAGAIN) break;
 
-    } //end switch
-}
+        //replayed & normal events are queued alike
+        if (ret != LIBEVDEV_READ_STATUS_SUCCESS
+            && ret != LIBEVDEV_READ_STATUS_SYNC) {
+            js->input_failed = true;
+            ev_del(&_js_loop, js->evdev_fd);
+            _schedule_js_step();
+            break;
+        }
 
+        //a frame becomes visible once its SYN_REPORT arrives
+        queue->len += 1;
+        if (in_event->type == EV_SYN && in_event->code == SYN_REPORT)
+            queue->committed = queue->len;
+    }
 
-//linux-to-macro button mapping for axes (+ description string)
-static inline int _lookup_axis_desc(int keycode, const char ** desc) {
+    //never stall on a frame too large for the queue
+    if (queue->len == JS_QUEUE_LEN && queue->committed == 0)
+        queue->committed = queue->len;
 
-    switch (keycode) {
+    return;
+}
 
-        case ABS_X:
-            *desc = "Analog stick X-axis";
-            return MENU_KEY_ABS_X;
 
-        case ABS_Y:
-            *desc = "Analog stick Y-axis";
-            return MENU_KEY_ABS_Y;
+//queue the pending inputs of a ready joystick
+static void _on_js_readable(int fd, uint32_t events, void * ctx) {
 
-        case ABS_HAT0X:
-            *desc = "D-pad X-axis";
-            return MENU_KEY_DPAD_X;
+    int idx = (int) (intptr_t) ctx;
 
-        case ABS_HAT0Y:
-            *desc = "D-pad Y-axis";
-            return MENU_KEY_DPAD_Y;
 
-        default:
-            *desc = NULL;
-            return -1;
+    //a disconnected joystick is closed & retried by the next step
+    if ((events & (EPOLLHUP | EPOLLERR)) != 0) {
+        _get_js_dev(idx)->input_failed = true;
+        ev_del(&_js_loop, fd);
+        _schedule_js_step();
+        return;
+    }
 
-    } //end switch
+    _drain_js(idx);
+    return;
 }
 
 
 //open a joystick event device & its associated libevdev context
-static void _open_js(int idx) {
+static int _open_js(int idx, bool is_diag) {
 
     int ret;
-    const char * key_desc;
+    struct input_absinfo absinfo;
+    struct js_dev * js = _get_js_dev(idx);
 
 
+    //reset per-device input state
+    js->queue.head      = 0;
+    js->queue.len       = 0;
+    js->queue.committed = 0;
+    js->input_failed    = false;
+    js->is_syncing      = false;
+    js->is_backlogged   = false;
+
     //open the joystick event device for nonblocking reading
-    js_state.js[idx].evdev_fd = open(js_state.js[idx].evdev_path,
-                                     O_RDONLY | O_NONBLOCK);
-    if (js_state.js[idx].evdev_fd < 0) {
-        js_state.js[idx].is_good = false;
-        return;
-    }
+    js->evdev_fd = open(js->evdev_path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (js->evdev_fd < 0) return -1;
 
-    //create a libevdev context
-    ret = libevdev_new_from_fd(js_state.js[idx].evdev_fd,
-                               &js_state.js[idx].evdev);
-    if (ret != 0) {
-        js_state.js[idx].is_good = false;
-        goto _open_js_cleanup_fd;
+    //probe & cache the keymap of an unknown joystick
+    if (js->is_probed == false) {
+
+        ret = _probe_js_keys(js->evdev_fd, js->keys);
+        if (ret != 0) goto _open_js_cleanup_fd;
+
+        js->is_probed = true;
+        js->is_good   = _is_js_good(idx);
+        caps_store(&js->caps_id, js->keys);
     }
 
-    //populate available button mappings
-    for (int i = 0; i < KEY_MAX; i++) {        
+    //joysticks that can't drive the menu are only read for diagnostics
+    if (js->is_good == false && is_diag == false) goto _open_js_cleanup_fd;
 
-        if (libevdev_has_event_code(
-                js_state.js[idx].evdev, EV_KEY, i)) {
+    //fetch axis ranges for diagnostics, failure leaves them unknown
+    for (int i = 0; i < KEY_OPT_NUM; ++i) {
 
-            ret = _lookup_key(i);
-            if (ret >= 0) js_state.js[idx].keys[ret] = true;
-        }
+        js->abs_range[i] = 0;
+        if (js_key_codes[i].type != EV_ABS || js->keys[i] == false) continue;
+
+        ret = ioctl(js->evdev_fd, EVIOCGABS(js_key_codes[i].code), &absinfo);
+        if (ret == 0) js->abs_range[i] = absinfo.maximum - absinfo.minimum;
     }
 
-    //populate available axis mappings
-    for (int i = 0; i < ABS_MAX; i++) {        
+    //create a libevdev context
+    ret = libevdev_new_from_fd(js->evdev_fd, &js->evdev);
+    if (ret != 0) goto _open_js_cleanup_fd;
 
-        if (libevdev_has_event_code(js_state.js[idx].evdev, EV_ABS, i)) {
-            ret = _lookup_axis_desc(i, &key_desc);
-        
-            if (ret >= 0) js_state.js[idx].keys[ret] = true;
-        }
-    }
+    //timestamp inputs with the clock latency is measured against
+    libevdev_set_clock_id(js->evdev, CLOCK_MONOTONIC);
 
-    //check if all required buttons/axes are available
-    js_state.js[idx].is_good = true;
-    for (int i = 0; i < KEY_REQ_NUM; ++i) {
-        if (js_state.js[idx].keys[i] == false) {
-            js_state.js[idx].is_good = false;
-        }
-    }
-    js_state.js[idx].is_open = true;
+    //wake up the event loop when this joystick has input
+    ret = ev_add(&_js_loop, js->evdev_fd,
+                 EPOLLIN, _on_js_readable, (void *) (intptr_t) idx);
+    if (ret != 0) goto _open_js_cleanup_evdev;
 
     //normal return
-    return;
+    return 0;
 
     //error return
+    _open_js_cleanup_evdev:
+    libevdev_free(js->evdev);
+
     _open_js_cleanup_fd:
-    close(js_state.js[idx].evdev_fd);
-    return;
+    close(js->evdev_fd);
+    return -1;
 }
 
 
 //release resources associated with an open joystick
 static void _close_js(int idx) {
-    
-    //cleanup the libevdev context
-    libevdev_free(js_state.js[idx].evdev);
-    close(js_state.js[idx].evdev_fd);
 
-    //mark this joystick as no longer open
-    js_state.js[idx].is_open = false;
+    struct js_dev * js = _get_js_dev(idx);
+
+
+    //stop watching the device & cleanup the libevdev context
+    ev_del(&_js_loop, js->evdev_fd);
+    libevdev_free(js->evdev);
+    close(js->evdev_fd);
+
+    //drop inputs that were not dispatched yet
+    js->queue.len       = 0;
+    js->queue.committed = 0;
+    js->is_backlogged   = false;
 
     return;
 }
 
 
-//close a joystick event & its assoicated libevdev context
-static void _cleanup_js(int idx) {
+//get the printable name of a joystick slot's status
+const char * js_status_str(enum js_status status) {
+
+    switch (status) {
+        case JS_ABSENT:   return "ABSENT";
+        case JS_PROBING:  return "PROBING";
+        case JS_OPEN:     return "OPEN";
+        case JS_FAILED:   return "FAILED";
+        case JS_UNUSABLE: return "UNUSABLE";
+        case JS_DIAG:     return "DIAG";
+    }
+
+    return "UNKNOWN";
+}
+
+
+//schedule the retry of a joystick that failed, doubling the delay
+static void _fail_js(int idx, uint64_t now) {
 
-    //close the joystick
-    _close_js(idx);
+    int shift;
+    uint64_t delay;
 
-    //cleanup the key mappings
-    memset(js_state.js[idx].keys, 0, KEY_OPT_NUM);
+    struct js_dev * js = _get_js_dev(idx);
+
+
+    js->fail_count += 1;
+    shift = MIN(js->fail_count - 1, 16);
+    delay = MIN((uint64_t) JS_BACKOFF_MIN_MS << shift,
+                (uint64_t) JS_BACKOFF_MAX_MS);
+
+    js->retry_ms = now + delay;
+    js->status   = JS_FAILED;
 
     return;
 }
 
 
-//populate keymap of a non-main joystuck
-static void _keymap_js(int idx) {
+//probe & open a present joystick
+static void _try_open_js(int idx, uint64_t now) {
+
+    struct js_dev * js = _get_js_dev(idx);
+
+
+    //the keymap of a known model is ready without probing
+    if (js->is_probed == false
+        && caps_lookup(&js->caps_id, js->keys) == true) {
+        js->is_probed = true;
+        js->is_good   = _is_js_good(idx);
+    }
+
+    //joysticks that can't drive the menu are never opened for reading
+    if (js->is_probed == true && js->is_good == false) {
+        js->status = JS_UNUSABLE;
+        return;
+    }
 
-    //open this joystick & populate its keymap
-    _open_js(idx);
+    if (_open_js(idx, false) == 0) {
+        js->status     = JS_OPEN;
+        js->fail_count = 0;
+        return;
+    }
 
-    //close the joystick without cleaning the keymap
-    _close_js(idx);
+    //probing during the open attempt may have found missing keys
+    if (js->is_probed == true && js->is_good == false) {
+        js->status = JS_UNUSABLE;
+        return;
+    }
 
+    _fail_js(idx, now);
     return;
 }
 
 
-//populate joystick-meta global state
-void update_js_state() {
+/*
+ *  NOTE: Each slot moves ABSENT -> PROBING -> OPEN. A slot that fails to
+ *        open or read moves to FAILED & is retried once its deadline
+ *        passes, the deadline doubling with every consecutive failure.
+ *        Disappearing from the index returns any slot to ABSENT, and a
+ *        replaced event device restarts probing without a delay. While
+ *        diagnostics are shown, UNUSABLE slots are read as DIAG.
+ */
+
+//advance a joystick slot's state machine
+static void _step_js(int idx, uint64_t now) {
+
+    struct js_dev * js = _get_js_dev(idx);
+
+
+    //a joystick that disappeared or was replaced starts over
+    if (js->is_present == false || js->is_replaced == true) {
+
+        if (js->status == JS_OPEN || js->status == JS_DIAG) _close_js(idx);
+        js->is_replaced = false;
+        js->fail_count  = 0;
+        js->status      = JS_ABSENT;
 
-    bool skip_idx[4] = {0};
-    bool found_next;
+        //free the slot & forget the keymap of joysticks that disappeared
+        if (js->is_present == false) {
+            js->js_devnum = 0;
+            js->is_probed = false;
+            js->is_good   = false;
+            memset(js->keys, 0, KEY_OPT_NUM);
+            return;
+        }
+    }
 
+    switch (js->status) {
+
+        case JS_ABSENT:
+        case JS_PROBING:
+            js->status = JS_PROBING;
+            _try_open_js(idx, now);
+            break;
+
+        case JS_OPEN:
+            if (js->input_failed == false) break;
+            _close_js(idx);
+            _fail_js(idx, now);
+            break;
+
+        case JS_FAILED:
+            if (now < js->retry_ms) break;
+            js->status = JS_PROBING;
+            _try_open_js(idx, now);
+            break;
+
+        //unusable joysticks are only read while diagnostics are shown
+        case JS_UNUSABLE:
+            if (atomic_load(&_js_diag) == false) break;
+            if (_open_js(idx, true) == 0) js->status = JS_DIAG;
+            break;
+
+        case JS_DIAG:
+            if (atomic_load(&_js_diag) == true
+                && js->input_failed == false) break;
+            _close_js(idx);
+            js->status = JS_UNUSABLE;
+            break;
+
+    } //end switch
+
+    return;
+}
+
+
+//arm the timer for the earliest pending retry or rescan
+static void _arm_js_timer(uint64_t now) {
+
+    uint64_t next, delay;
+
+
+    //without hotplug events devices are rescanned periodically
+    next = (_udev_mon == NULL) ? now + JS_RESCAN_MS : UINT64_MAX;
+
+    for (int i = 0; i < _js_devs.len; ++i) {
+        if (_get_js_dev(i)->status == JS_FAILED)
+            next = MIN(next, _get_js_dev(i)->retry_ms);
+    }
+
+    //disarm the timer if nothing is pending
+    if (next == UINT64_MAX) {
+        ev_set_timer(_js_timer_fd, 0, 0);
+        return;
+    }
+
+    delay = (next > now) ? next - now : 1;
+    ev_set_timer(_js_timer_fd, (int) delay, 0);
+
+    return;
+}
+
+
+//advance every joystick slot & schedule the next retry
+static void _setup_js() {
+
+    uint64_t now = mono_ms();
+
+
+    for (int i = 0; i < _js_devs.len; ++i) _step_js(i, now);
+    _arm_js_timer(now);
+
+    return;
+}
+
+
+//populate joystick states with a full device rescan
+static void _update_js_state() {
 
     //reset error state
-    subsys_state.udev_good = true;
+    atomic_store(&subsys_state.udev_good, true);
 
     //update individual joystick states
     _update_js_devices();
+    _setup_js();
 
+    return;
+}
 
-    //if the main joystick is present and setup
-    if (js_state.js[js_state.main_js_idx].is_present == true
-        && js_state.js[js_state.main_js_idx].is_open == true)
-            goto _update_js_state_success;
 
-    //if the main joystick just became not present, tear it down
-    if (js_state.js[js_state.main_js_idx].is_open == true
-        && js_state.js[js_state.main_js_idx].is_present == false)
-            _cleanup_js(js_state.main_js_idx);
+//retry failed joysticks, rescanning only if hotplug events are unavailable
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_js_timer(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
 
-    //if the main joystick is not present
-    if (js_state.js[js_state.main_js_idx].is_present == false) {
+    //acknowledge the expiry
+    ev_read_timer(fd);
 
-        //find a new main joystick
-        found_next = false;
-        for (int i = 0; i < 4; ++i) {
-            if (js_state.js[i].is_present) {
-                js_state.main_js_idx = i;
-                found_next = true;
-                break;
-            }
+    if (_udev_mon == NULL) {
+        _update_js_state();
+    } else {
+        _setup_js();
+    }
+
+    return;
+}
+
+
+//apply pending hotplug events
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_udev_readable(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    bool changed;
+    struct udev_device * device;
+
+
+    //reset error state
+    atomic_store(&subsys_state.udev_good, true);
+
+    //apply every received event
+    changed = false;
+    while (true) {
+
+        errno = 0;
+        device = udev_monitor_receive_device(_udev_mon);
+        if (device == NULL) break;
+
+        if (_apply_js_hotplug(device) == true) changed = true;
+        udev_device_unref(device);
+    }
+
+    //the monitor socket overflowed & events were lost, resync
+    if (errno == ENOBUFS) {
+        _update_js_devices();
+        changed = true;
+    }
+
+    //setup joysticks, the changes are published after this batch
+    if (changed == false) return;
+    _sync_js_slots();
+    _setup_js();
+
+    return;
+}
+
+
+//subscribe to input subsystem hotplug events
+static void _init_udev_monitor() {
+
+    int ret;
+
+
+    _udev_mon = udev_monitor_new_from_netlink(_udev_ctx, "udev");
+    if (_udev_mon == NULL) goto _init_udev_monitor_fail;
+
+    ret = udev_monitor_filter_add_match_subsystem_devtype(
+              _udev_mon, "input", NULL);
+    if (ret < 0) goto _init_udev_monitor_cleanup;
+
+    //a larger buffer survives bursts of hub events, failure is harmless
+    udev_monitor_set_receive_buffer_size(_udev_mon, JS_MON_BUF_SZ);
+
+    ret = udev_monitor_enable_receiving(_udev_mon);
+    if (ret < 0) goto _init_udev_monitor_cleanup;
+
+    ret = ev_add(&_js_loop, udev_monitor_get_fd(_udev_mon),
+                 EPOLLIN, _on_udev_readable, NULL);
+    if (ret != 0) goto _init_udev_monitor_cleanup;
+
+    return;
+
+    //without a monitor, devices are rescanned periodically instead
+    _init_udev_monitor_cleanup:
+    udev_monitor_unref(_udev_mon);
+    _udev_mon = NULL;
+
+    _init_udev_monitor_fail:
+    atomic_store(&subsys_state.udev_good, false);
+    return;
+}
+
+
+//find the joystick whose oldest complete frame happened first
+static int _next_js_input() {
+
+    int next_idx;
+    struct timeval * next_time, * time;
+    struct js_queue * queue;
+
+
+    next_idx  = -1;
+    next_time = NULL;
+    for (int pass = 0; pass < 2 && next_idx < 0; ++pass) {
+
+        //once the queues run dry, refill those that filled up earlier
+        for (int i = 0; i < _js_devs.len && pass == 1; ++i) {
+            if (_get_js_dev(i)->is_backlogged == true
+                && _get_js_dev(i)->input_failed == false) _drain_js(i);
         }
 
-        //if no other joysticks are available, give up
-        if (found_next == false) {
-            js_state.main_js_idx = 0;
-            goto _update_js_state_fail;
+        for (int i = 0; i < _js_devs.len; ++i) {
+
+            queue = &_get_js_dev(i)->queue;
+            if (queue->committed == 0) continue;
+
+            time = &queue->events[queue->head].time;
+            if (next_time == NULL || timercmp(time, next_time, <)) {
+                next_idx  = i;
+                next_time = time;
+            }
         }
     }
 
-    //try to setup all joysticks starting with the current main
-    for (int i = 0; i < 4; ++i) {
+    return next_idx;
+}
+
 
-        //for the next unskipped joystick
-        for (int j = 0; j < 4; ++j) {
+//take the state of a joystick that the menu displays
+static void _get_js_info(int idx, struct js_info * info) {
 
-            found_next = false;
+    struct js_dev * js = _get_js_dev(idx);
 
-            //try to setup twice before giving up
-            for (int k = 0; k < 2; ++k) {
-                _open_js(js_state.main_js_idx);
-                if (js_state.js[js_state.main_js_idx].is_open) {
-                    js_state.have_main_js = true;
-                    break;
-                }    
-            } //end setup attempts
 
-            //if setup succeeded, return
-            if (js_state.have_main_js == true) {
-                goto _update_js_state_success;
+    //clear padding, published states are compared bytewise
+    memset(info, 0, sizeof(*info));
 
-            //else, mark this joystick as skipped
-            } else {
-                skip_idx[js_state.main_js_idx] = true;
-            } 
+    info->status         = js->status;
+    info->fail_count     = js->fail_count;
+    info->dropped_frames = js->dropped_frames;
+    memcpy(info->keys, js->keys, sizeof(info->keys));
+    memcpy(info->vendor, js->vendor, JS_NAME_SZ);
+    memcpy(info->model, js->model, JS_NAME_SZ);
+    memcpy(info->abs_range, js->abs_range, sizeof(info->abs_range));
 
-            //find the next main joystick index
-            found_next = false;
-            for (int k = 0; k < 4; ++k) {
+    return;
+}
 
-                if (js_state.js[k].is_present == true
-                    && skip_idx[k] == false) {
 
-                    js_state.main_js_idx = k;
-                    found_next = true;
-                    break;
-                }
-            }
+/*
+ *  NOTE: When the ring is full the device thread sets `_js_ring_stalled`
+ *        & retries once, leaving unpublished inputs in the joystick
+ *        queues. The menu checks the flag after emptying the ring & asks
+ *        the device thread to resume. The fences order each side's flag
+ *        & index accesses, so either the retry finds room or the menu
+ *        sees the flag.
+ */
+
+//publish a message to the menu, returns false if the ring is full
+static bool _push_js_msg(const struct js_msg * msg) {
+
+    if (ring_push(&_js_ring, msg) == true) return true;
+
+    atomic_store(&_js_ring_stalled, true);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    return ring_push(&_js_ring, msg);
+}
+
+
+//publish joystick changes & complete input frames to the menu
+static void _publish_js() {
+
+    int idx;
+    bool is_pushed;
+
+    struct js_msg msg;
+    struct js_queue * queue;
+
+
+    is_pushed = false;
+    msg.publish_us = lat_now_us();
+
+    //device changes go first, inputs may come from a joystick just opened
+    for (int i = 0; i < _js_devs.len; ++i) {
+
+        _get_js_info(i, &msg.info);
+        if (memcmp(&msg.info, &_get_js_dev(i)->published,
+                   sizeof(msg.info)) == 0)
+            continue;
+
+        msg.type = JS_MSG_INFO;
+        msg.idx  = i;
+        if (_push_js_msg(&msg) == false) goto _publish_js_notify;
+
+        _get_js_dev(i)->published = msg.info;
+        is_pushed = true;
+    }
+
+    //inputs are published oldest first & only popped once published
+    while ((idx = _next_js_input()) >= 0) {
+
+        queue = &_get_js_dev(idx)->queue;
+
+        msg.type     = JS_MSG_INPUT;
+        msg.idx      = idx;
+        msg.in_event = queue->events[queue->head];
+        if (_push_js_msg(&msg) == false) break;
+
+        queue->head = (queue->head + 1) % JS_QUEUE_LEN;
+        queue->len -= 1;
+        queue->committed -= 1;
+        is_pushed = true;
+    }
+
+    _publish_js_notify:
+    if (is_pushed == true) ev_notify(_js_ready_fd);
+    return;
+}
+
+
+//publish after every batch of device thread events
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_js_batch(void * ctx) {
+#pragma GCC diagnostic pop
+
+    _publish_js();
+    return;
+}
+
+
+//the menu made room in the ring, resume publishing
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_js_resume(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    ev_read_notify(fd);
+    return;
+}
+
+
+//diagnostics were shown or hidden, open or close unusable joysticks
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_js_diag(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    ev_read_notify(fd);
+    _setup_js();
+
+    return;
+}
+
+
+//stop the device thread
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_js_stop(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
 
-            //if no joysticks left, stop trying
-            if (found_next == false) goto _update_js_state_fail;
+    ev_read_notify(fd);
+    ev_stop(&_js_loop);
 
-        } //end next unskipped joystick
+    return;
+}
+
+
+//device thread: scan, then watch devices until stopped
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void * _js_thread_main(void * arg) {
+#pragma GCC diagnostic pop
+
+    _update_js_state();
+    _publish_js();
+
+    ev_run(&_js_loop);
+
+    return NULL;
+}
+
+
+//wake the menu's loop, messages are consumed by `next_input()`
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_js_ready(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    ev_read_notify(fd);
+    return;
+}
+
+
+//start the device thread, which publishes to the menu's `loop`
+void init_js(struct ev_loop * loop, js_change_cb change_cb) {
+
+    int ret;
+
+
+    js_state.active_js_idx = -1;
+    _js_menu_loop = loop;
+    _js_change_cb = change_cb;
+
+    //setup the device table & the menu's copy of it
+    ret = cm_new_vct(&_js_devs, sizeof(struct js_dev));
+    if (ret != 0) FATAL_FAIL("Failed to initialise the joystick table.");
+
+    ret = cm_new_vct(&js_state.js, sizeof(struct js_single_state));
+    if (ret != 0) FATAL_FAIL("Failed to initialise the joystick table.");
+
+    //setup the message ring & the menu's notification source
+    init_ring(&_js_ring, JS_RING_LEN, sizeof(struct js_msg));
+    atomic_init(&_js_ring_stalled, false);
+
+    _js_ready_fd = ev_add_notify(loop, _on_js_ready, NULL);
+    if (_js_ready_fd < 0) FATAL_FAIL("Failed to create a notification source.")
+
+    //setup the device thread's sources, publishing after each batch
+    init_ev_loop(&_js_loop);
+    ev_set_batch_cb(&_js_loop, _on_js_batch, NULL);
+
+    atomic_init(&_js_diag, false);
+
+    _js_stop_fd   = ev_add_notify(&_js_loop, _on_js_stop, NULL);
+    _js_resume_fd = ev_add_notify(&_js_loop, _on_js_resume, NULL);
+    _js_diag_fd   = ev_add_notify(&_js_loop, _on_js_diag, NULL);
+    if (_js_stop_fd < 0 || _js_resume_fd < 0 || _js_diag_fd < 0)
+        FATAL_FAIL("Failed to create a notification source.")
+
+    //retries are armed on demand by each setup
+    _js_timer_fd = ev_add_timer(&_js_loop, 0, _on_js_timer, NULL);
+    if (_js_timer_fd < 0) FATAL_FAIL("Failed to create a timer source.")
 
-    } //end try to setup all joysticks
+    //hotplug events must be subscribed to before the first scan
+    _init_udev_monitor();
+
+    //signals stay blocked in the device thread, they are read by the menu
+    ret = pthread_create(&_js_thread, NULL, _js_thread_main, NULL);
+    if (ret != 0) FATAL_FAIL("Failed to start the device thread.")
 
-    _update_js_state_fail:
-    js_state.have_main_js = false;
     return;
+}
 
-    _update_js_state_success:
-    js_state.have_main_js = true;
-    js_state.input_failed = false;
 
-    //populate keymaps of other controllers
-    for (int i = 0; i < 4; ++i) {
+//stop the device thread & close every joystick
+void fini_js() {
 
-        //skip the main joystick & skipped joysticks
-        if (js_state.js[i].is_present == false
-            || skip_idx[i] == true || js_state.main_js_idx == i) continue;
-        _keymap_js(i);
+    ev_notify(_js_stop_fd);
+    pthread_join(_js_thread, NULL);
+
+    //the device thread is gone, its state is safe to touch
+    for (int i = 0; i < _js_devs.len; ++i) {
+        if (_get_js_dev(i)->status == JS_OPEN
+            || _get_js_dev(i)->status == JS_DIAG) _close_js(i);
     }
 
+    close(_js_timer_fd);
+    close(_js_diag_fd);
+    close(_js_resume_fd);
+    close(_js_stop_fd);
+    ev_del(_js_menu_loop, _js_ready_fd);
+    close(_js_ready_fd);
+    fini_ev_loop(&_js_loop);
+    fini_ring(&_js_ring);
+
+    cm_del_vct(&js_state.js);
+    cm_del_vct(&_js_devs);
+
+    return;
+}
+
+
+//also read joysticks that lack required keys, for diagnostics
+void js_set_diag(bool is_diag) {
+
+    atomic_store(&_js_diag, is_diag);
+    ev_notify(_js_diag_fd);
+
     return;
 }
 
 
-//receive the next input event from libevdev & dispatch an action
-int next_input(struct input_event * in_event) {
+//apply a joystick state published by the device thread
+static void _apply_js_info(int idx, const struct js_info * info) {
 
     int ret;
+    struct js_single_state * js, new_js;
+
+
+    //the device table grew, grow the menu's copy with it
+    memset(&new_js, 0, sizeof(new_js));
+    while (js_state.js.len <= idx) {
+        ret = cm_vct_apd(&js_state.js, &new_js);
+        if (ret != 0) FATAL_FAIL("Failed to grow the joystick table.")
+    }
+    js = cm_vct_get_p(&js_state.js, idx);
+
+    js_state.dropped_frames += info->dropped_frames - js->info.dropped_frames;
+    js->info = *info;
+    js_state.gen += 1;
+
+    _js_change_cb();
+    return;
+}
+
+
+//receive the next published input, applying device changes on the way
+int next_input(int * idx, struct input_event * in_event,
+               uint64_t * publish_us) {
+
+    struct js_msg msg;
+
+
+    while (ring_pop(&_js_ring, &msg) == true) {
+
+        if (msg.type == JS_MSG_INFO) {
+            _apply_js_info(msg.idx, &msg.info);
+            continue;
+        }
+
+        *idx        = msg.idx;
+        *in_event   = msg.in_event;
+        *publish_us = msg.publish_us;
+        return 1;
+    }
 
+    //the ring is empty, let a stalled device thread publish again
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_exchange(&_js_ring_stalled, false) == true)
+        ev_notify(_js_resume_fd);
 
-    //receive the next input event
-    ret = libevdev_next_event(
-              js_state.js[js_state.main_js_idx].evdev,
-              LIBEVDEV_READ_FLAG_NORMAL, in_event);
-    if (ret == -EAGAIN) {
-        return 0;
-    } else if (ret != 0) {
-        js_state.input_failed = true;
-        return 0;
-    } else { return 1; }
+    return 0;
 }
@@ -3,24 +3,41 @@
 
 //C standard library
 #include <stdbool.h>
+#include <stdint.h>
 
 //system headers
 #include <linux/limits.h>
 
 //external libraries
 #include <libevdev-1.0/libevdev/libevdev.h>
+#include <cmore.h>
 
 //local headers
 #include "common.h"
+#include "event.h"
 
 
 // -- [macros] --
 
-//lead joystick udev device path
-#define JS0_DEVFS_PATH "/dev/input/js0"
-#define JS1_DEVFS_PATH "/dev/input/js1"
-#define JS2_DEVFS_PATH "/dev/input/js2"
-#define JS3_DEVFS_PATH "/dev/input/js3"
+//joystick device path & name buffer sizes
+#define JS_DEVFS_SZ 64
+#define JS_NAME_SZ 128
+
+//per-joystick input queue length
+#define JS_QUEUE_LEN 64
+
+//device thread to menu message ring length, a power of two
+#define JS_RING_LEN 256
+
+//hotplug monitor receive buffer size
+#define JS_MON_BUF_SZ (128 * 1024)
+
+//failed joystick retry backoff bounds
+#define JS_BACKOFF_MIN_MS 250
+#define JS_BACKOFF_MAX_MS 30000
+
+//device rescan interval when hotplug events are unavailable
+#define JS_RESCAN_MS 2000
 
 //keys - other
 #define KEY_DESC_LEN 32
@@ -46,39 +63,76 @@
 
 // -- [data] --
 
-//joystick global state
-struct js_single_state {
+//joystick slot lifecycle
+enum js_status {
+
+    JS_ABSENT,   //no joystick in this slot
+    JS_PROBING,  //present, about to be probed & opened
+    JS_OPEN,     //open & read
+    JS_FAILED,   //failed to open or read, waiting for a retry
+    JS_UNUSABLE, //lacks required keys, ignored until replugged
+    JS_DIAG      //lacks required keys, read only for diagnostics
+};
+
+
+//linux event type & code of a menu key
+struct js_key_code {
+
+    int type;
+    int code;
+};
+
 
-    char evdev_path[PATH_MAX];
-    char vendor[PATH_MAX];
-    char model[PATH_MAX];
+//controller state published by the device thread
+struct js_info {
 
-    bool is_present;
-    bool is_good;
-    bool is_open;
+    enum js_status status;
+    int fail_count;
+
+    //SYN_DROPPED overflows, each losing one or more frames
+    unsigned long dropped_frames;
 
-    int evdev_fd;
     bool keys[KEY_OPT_NUM];
-    struct libevdev * evdev;
+    char vendor[JS_NAME_SZ];
+    char model[JS_NAME_SZ];
+
+    //value range of each axis, 0 if unknown
+    int abs_range[KEY_OPT_NUM];
+};
+
+
+//menu's copy of a joystick
+struct js_single_state {
+
+    struct js_info info;
 };
 
 
-//joystick-meta global state
+//joystick-meta global state, owned by the menu thread
 struct js_state {
 
-    bool have_main_js;
-    bool input_failed;
+    int active_js_idx;
+    unsigned long dropped_frames;
 
-    int main_js_idx;    
-    struct js_single_state js[4];
+    //bumped whenever a controller or the active controller changes
+    unsigned long gen;
+
+    cm_vct js; //type: struct js_single_state
 };
 
 
+//joystick state change callback
+typedef void (* js_change_cb)();
+
+
 // -- [globals] --
 
 //global joystick state
 extern struct js_state js_state;
 
+//linux event type & code of each menu key
+extern const struct js_key_code js_key_codes[KEY_OPT_NUM];
+
 
 // -- [text] --
 
@@ -86,14 +140,21 @@ extern struct js_state js_state;
 void init_udev();
 void fini_udev();
 
-//initialise global joystick state
-void init_js();
+//start the device thread, which publishes to the menu's `loop`
+void init_js(struct ev_loop * loop, js_change_cb change_cb);
+
+//stop the device thread & close every joystick
+void fini_js();
+
+//also read joysticks that lack required keys, for diagnostics
+void js_set_diag(bool is_diag);
 
-//populate joystick-meta global state
-void update_js_state();
+//get the printable name of a joystick slot's status
+const char * js_status_str(enum js_status status);
 
-//receive the next input event from libevdev & dispatch an action
-int next_input(struct input_event * in_event);
+//receive the next published input, applying device changes on the way
+int next_input(int * idx, struct input_event * in_event,
+               uint64_t * publish_us);
 
 
 #endif
@@ -0,0 +1,160 @@
+//C standard library
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+
+//system headers
+#include <sys/time.h>
+
+//local headers
+#include "common.h"
+#include "latency.h"
+
+
+/*
+ *  NOTE: Histograms are only touched by the menu thread. Stages measured
+ *        on the device thread are carried to the menu as timestamps.
+ *        Input timestamps come from CLOCK_MONOTONIC once libevdev sets
+ *        the device's clock, so they compare against `lat_now_us()`.
+ */
+
+// -- [globals] --
+
+//per-stage histograms
+static struct lat_hist _lat_hist[LAT_STAGE_NUM];
+
+
+// -- [text] --
+
+//reset every histogram
+void init_lat() {
+
+    memset(_lat_hist, 0, sizeof(_lat_hist));
+    return;
+}
+
+
+//get the monotonic clock in microseconds
+uint64_t lat_now_us() {
+
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000;
+}
+
+
+//convert an input timestamp to microseconds
+uint64_t lat_tv_us(const struct timeval * tv) {
+
+    return (uint64_t) tv->tv_sec * 1000000 + (uint64_t) tv->tv_usec;
+}
+
+
+//record a stage's latency between two timestamps, skipping clock skew
+void lat_record(enum lat_stage stage, uint64_t start_us, uint64_t end_us) {
+
+    uint64_t us, bucket;
+    struct lat_hist * hist = &_lat_hist[stage];
+
+
+    //a device without a monotonic clock reports wall clock timestamps
+    if (end_us < start_us) return;
+    us = end_us - start_us;
+
+    bucket = us / LAT_BUCKET_US;
+    if (bucket >= LAT_BUCKET_NUM) bucket = LAT_BUCKET_NUM - 1;
+
+    hist->buckets[bucket] += 1;
+    hist->count += 1;
+    if (us > hist->max_us) hist->max_us = us;
+
+    return;
+}
+
+
+//get a stage's latency percentile in microseconds
+uint64_t lat_percentile(enum lat_stage stage, int pct) {
+
+    uint64_t rank, seen;
+    struct lat_hist * hist = &_lat_hist[stage];
+
+
+    if (hist->count == 0) return 0;
+
+    //the smallest bucket covering `pct` percent of samples
+    rank = (hist->count * pct + 99) / 100;
+    seen = 0;
+    for (int i = 0; i < LAT_BUCKET_NUM; ++i) {
+
+        seen += hist->buckets[i];
+        if (seen >= rank) return MIN((uint64_t) (i + 1) * LAT_BUCKET_US,
+                                     hist->max_us);
+    }
+
+    return hist->max_us;
+}
+
+
+//get a stage's maximum latency in microseconds
+uint64_t lat_max(enum lat_stage stage) {
+
+    return _lat_hist[stage].max_us;
+}
+
+
+//get the printable name of a stage
+const char * lat_stage_str(enum lat_stage stage) {
+
+    switch (stage) {
+        case LAT_READ:    return "READ";
+        case LAT_QUEUE:   return "QUEUE";
+        case LAT_HANDLE:  return "HANDLE";
+        case LAT_DRAW:    return "DRAW";
+        case LAT_REFRESH: return "REFRESH";
+        case LAT_TOTAL:   return "TOTAL";
+        default:          break;
+    }
+
+    return "UNKNOWN";
+}
+
+
+//write every histogram to a file, returns 0 on success
+int lat_dump(const char * path) {
+
+    int ret;
+    FILE * file;
+    struct lat_hist * hist;
+
+
+    file = fopen(path, "w");
+    if (file == NULL) return -1;
+
+    //summary, then the non-empty buckets of each stage
+    fprintf(file, "# stage count p50_us p99_us max_us\n");
+    for (int i = 0; i < LAT_STAGE_NUM; ++i) {
+        fprintf(file, "%s %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 "\n",
+                lat_stage_str(i),
+                _lat_hist[i].count, lat_percentile(i, 50),
+                lat_percentile(i, 99), lat_max(i));
+    }
+
+    fprintf(file, "\n# stage bucket_start_us count\n");
+    for (int i = 0; i < LAT_STAGE_NUM; ++i) {
+
+        hist = &_lat_hist[i];
+        for (int j = 0; j < LAT_BUCKET_NUM; ++j) {
+            if (hist->buckets[j] == 0) continue;
+            fprintf(file, "%s %d %" PRIu32 "\n", lat_stage_str(i),
+                    j * LAT_BUCKET_US, hist->buckets[j]);
+        }
+    }
+
+    ret = fclose(file);
+    return (ret == 0) ? 0 : -1;
+}
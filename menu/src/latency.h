@@ -0,0 +1,71 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+//C standard library
+#include <stdbool.h>
+#include <stdint.h>
+
+//system headers
+#include <sys/time.h>
+
+//local headers
+#include "common.h"
+
+
+// -- [macros] --
+
+//histogram resolution & range, slower samples land in the last bucket
+#define LAT_BUCKET_US  100
+#define LAT_BUCKET_NUM 1000
+
+
+// -- [data] --
+
+//stages an input passes through on its way to the screen
+enum lat_stage {
+
+    LAT_READ,     //kernel timestamp -> published by the device thread
+    LAT_QUEUE,    //published -> received by the menu
+    LAT_HANDLE,   //received -> menu state updated
+    LAT_DRAW,     //menu state updated -> drawn
+    LAT_REFRESH,  //drawn -> written to the terminal
+    LAT_TOTAL,    //kernel timestamp -> written to the terminal
+    LAT_STAGE_NUM
+};
+
+
+//latency histogram of a stage
+struct lat_hist {
+
+    uint64_t count;
+    uint64_t max_us;
+    uint32_t buckets[LAT_BUCKET_NUM];
+};
+
+
+// -- [text] --
+
+//reset every histogram
+void init_lat();
+
+//get the monotonic clock in microseconds
+uint64_t lat_now_us();
+
+//convert an input timestamp to microseconds
+uint64_t lat_tv_us(const struct timeval * tv);
+
+//record a stage's latency between two timestamps, skipping clock skew
+void lat_record(enum lat_stage stage, uint64_t start_us, uint64_t end_us);
+
+//get a stage's latency percentile & maximum in microseconds
+uint64_t lat_percentile(enum lat_stage stage, int pct);
+uint64_t lat_max(enum lat_stage stage);
+
+//get the printable name of a stage
+const char * lat_stage_str(enum lat_stage stage);
+
+//write every histogram to a file, returns 0 on success
+int lat_dump(const char * path);
+
+
+#endif
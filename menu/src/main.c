@@ -1,10 +1,12 @@
 //C standard library
 #include <stdio.h>
-#include <time.h>
+#include <stdint.h>
 #include <pwd.h>
 
 //system headers
 #include <unistd.h>
+#include <signal.h>
+#include <sys/signalfd.h>
 
 //kernel headers
 #include <linux/input.h>
@@ -16,37 +18,56 @@
 
 //local headers
 #include "common.h"
+#include "caps.h"
+#include "event.h"
 #include "input.h"
 #include "data.h"
 #include "display.h"
 #include "state.h"
+#include "latency.h"
+#include "diag.h"
+#include "render.h"
+#include "stats.h"
+
+
+// -- [macros] --
+
+//quiet period that ends a burst of terminal resizes
+#define RESIZE_SETTLE_MS 50
+
+//command line usage
+#define USAGE "Usage: menu [-r curses|ansi] [-e sfc,smc,...]"
 
 
 // -- [data] --
 
-//tracking whether a key is pressed
-bool is_down[KEY_REQ_NUM] = {0};
+//menu actions decoded from inputs
+enum input_action {
+    ACTION_NONE,
+    ACTION_UP,
+    ACTION_DOWN,
+    ACTION_ACTIVATE,
+    ACTION_EXIT
+};
 
+//event loop of the menu
+static struct ev_loop _menu_loop;
 
-// -- [text] --
+//one-shot timer relaying out the display after a resize
+static int _resize_timer_fd;
 
-//keep track of key presses & don't affect menu if a ROM is running
-static void _handle_key(int key, void(* cb)()) {
 
-    if (is_down[key] == false) { 
-        subsys_state.execve_good = true;
-        cb();
-        is_down[key] = true;
-    } else {
-        is_down[key] = false;
-    }
+// -- [text] --
 
-    return;
+//return `action` only for a press, releases & autorepeats are ignored
+static enum input_action _handle_key(int value, enum input_action action) {
+
+    return (value == 1) ? action : ACTION_NONE;
 }
 
 
-//dispatch a received input
-static void _dispatch_input(struct input_event * in_event) {
+//decode a received input into a menu action
+static enum input_action _decode_input(struct input_event * in_event) {
     
     //if the input is a key type
     if (in_event->type == EV_KEY) {
@@ -54,20 +75,16 @@ static void _dispatch_input(struct input_event * in_event) {
         switch(in_event->code) {
 
             case BTN_SOUTH:
-                _handle_key(MENU_KEY_SOUTH, handle_activate);
-                break;
+                return _handle_key(in_event->value, ACTION_ACTIVATE);
 
             case BTN_EAST:
-                _handle_key(MENU_KEY_EAST, handle_exit);
-                break;
+                return _handle_key(in_event->value, ACTION_EXIT);
 
             case BTN_SELECT:
-                _handle_key(MENU_KEY_SELECT, handle_activate);
-                break;
+                return _handle_key(in_event->value, ACTION_ACTIVATE);
 
             case BTN_START:
-                _handle_key(MENU_KEY_START, handle_activate);
-                break;
+                return _handle_key(in_event->value, ACTION_ACTIVATE);
 
             default:
                 break;
@@ -79,20 +96,15 @@ static void _dispatch_input(struct input_event * in_event) {
         switch(in_event->code) {
 
             case ABS_HAT0Y:
-                if (in_event->value < -0.25) {
-                    subsys_state.execve_good = true;
-                    handle_up();
-                } else if (in_event->value > 0.25) {
-                    subsys_state.execve_good = true;
-                    handle_down();
-                }
+                if (in_event->value < -0.25) return ACTION_UP;
+                if (in_event->value > 0.25) return ACTION_DOWN;
                 break;
 
         } //end switch
 
     } //end event type
 
-    return;
+    return ACTION_NONE;
 }
 
 
@@ -115,54 +127,280 @@ static void _drop_privilege() {
 }
 
 
+//apply the inputs queued by every joystick during this wakeup
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
-int main(int argc, char ** argv, char ** envp) {
+static void _on_loop_batch(void * ctx) {
+#pragma GCC diagnostic pop
+
+    int idx, nav_delta;
+    enum input_action action;
+    struct input_event in_event;
+    struct js_single_state * js;
+
+    uint64_t input_us, publish_us, recv_us;
+    uint64_t first_input_us, first_recv_us, handled_us, drawn_us;
+
+
+    //decode every complete input frame queued during this wakeup
+    nav_delta = 0;
+    first_input_us = first_recv_us = 0;
+    while (next_input(&idx, &in_event, &publish_us) == 1) {
+
+        //every frame feeds the diagnostics while they run
+        diag_feed(idx, &in_event);
+
+        //controllers read only for diagnostics never drive the menu
+        js = cm_vct_get_p(&js_state.js, idx);
+        if (js == NULL || js->info.status != JS_OPEN) continue;
+
+        action = _decode_input(&in_event);
+        if (action == ACTION_NONE) continue;
+
+        //measure delivery of inputs that act on the menu
+        recv_us  = lat_now_us();
+        input_us = lat_tv_us(&in_event.time);
+        lat_record(LAT_READ, input_us, publish_us);
+        lat_record(LAT_QUEUE, publish_us, recv_us);
+
+        //the render below is as late as the oldest input it reflects
+        if (first_recv_us == 0) {
+            first_input_us = input_us;
+            first_recv_us  = recv_us;
+        }
+
+        //any action clears a failed launch & marks the acting controller
+        subsys_state.execve_good = true;
+        if (js_state.active_js_idx != idx) {
+            js_state.active_js_idx = idx;
+            js_state.gen += 1;
+        }
+
+        //coalesce navigation into a net delta
+        if (action == ACTION_UP) {
+            nav_delta -= 1;
+            continue;
+        }
+        if (action == ACTION_DOWN) {
+            nav_delta += 1;
+            continue;
+        }
+
+        //navigation that preceded an activation or exit applies first
+        if (nav_delta != 0) handle_move(nav_delta);
+        nav_delta = 0;
+
+        if (action == ACTION_ACTIVATE) handle_activate();
+        if (action == ACTION_EXIT) handle_exit();
+    }
+    if (nav_delta != 0) handle_move(nav_delta);
+    handled_us = lat_now_us();
+
+    //render everything this wakeup changed in a single pass
+    if (menu_state.needs_redraw == false) return;
+    redraw();
+    drawn_us = lat_now_us();
+    disp_refresh();
+    menu_state.needs_redraw = false;
+
+    //record the stages of renders caused by inputs
+    if (first_recv_us == 0) return;
+    lat_record(LAT_HANDLE, first_recv_us, handled_us);
+    lat_record(LAT_DRAW, handled_us, drawn_us);
+    lat_record(LAT_REFRESH, drawn_us, lat_now_us());
+    lat_record(LAT_TOTAL, first_input_us, lat_now_us());
+
+    return;
+}
+
+
+//redraw after a controller or diagnostics change
+static void _on_js_change() {
+
+    menu_state.needs_redraw = true;
+    return;
+}
+
+
+//show a new statistics snapshot if the info window is open
+static void _on_stats_change() {
+
+    if (menu_state.current_win != INFO) return;
+
+    disp_info_update();
+    menu_state.needs_redraw = true;
+
+    return;
+}
+
+
+//show ROM list changes & the progress of a walk
+static void _on_roms_change(bool is_changed) {
+
+    //the progress is drawn with the ROMs window, nothing else changed
+    if (is_changed == false) {
+        if (menu_state.current_win == ROMS) menu_state.needs_redraw = true;
+        return;
+    }
+
+    handle_roms_change();
+    stats_refresh();
+
+    return;
+}
+
+
+//lay the display out once terminal resizes settle
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_resize_timer(int fd, uint32_t events, void * ctx) {
 #pragma GCC diagnostic pop
 
+    ev_read_timer(fd);
+    disp_resize();
+    menu_state.needs_redraw = true;
+
+    return;
+}
+
+
+//handle a routed signal
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_signal(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    struct signalfd_siginfo siginfo;
+
+
+    //handle every pending signal
+    while (read(fd, &siginfo, sizeof(siginfo)) == sizeof(siginfo)) {
+
+        switch (siginfo.ssi_signo) {
+
+            case SIGWINCH:
+                //restarting the timer coalesces a burst of resizes
+                ev_set_timer(_resize_timer_fd, RESIZE_SETTLE_MS, 0);
+                break;
+
+            case SIGUSR1:
+                lat_dump(PATH_LAT);
+                break;
+
+            case SIGINT:
+            case SIGTERM:
+                ev_stop(&_menu_loop);
+                break;
+
+            default:
+                break;
+
+        } //end switch
+    }
+
+    return;
+}
+
+
+//route signals & input dispatch through the event loop
+static void _init_sources() {
+
     int ret;
+    sigset_t set;
 
-    time_t prev, now;
-    struct input_event in_event;
 
+    //deliver signals through a signalfd instead of asynchronous handlers
+    sigemptyset(&set);
+    sigaddset(&set, SIGWINCH);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    sigaddset(&set, SIGUSR1);
+
+    ret = ev_add_signals(&_menu_loop, &set, _on_signal, NULL);
+    if (ret < 0) FATAL_FAIL("Failed to create a signal source.")
+
+    //create the disarmed resize timer
+    _resize_timer_fd = ev_add_timer(&_menu_loop, 0, _on_resize_timer, NULL);
+    if (_resize_timer_fd < 0) FATAL_FAIL("Failed to create a resize timer.")
+
+    //dispatch joystick inputs once all ready devices were read
+    ev_set_batch_cb(&_menu_loop, _on_loop_batch, NULL);
+
+    return;
+}
+
+
+//parse the command line
+static void _parse_args(int argc, char ** argv) {
+
+    int ret, opt;
+
+
+    while ((opt = getopt(argc, argv, "r:e:")) != -1) {
+
+        switch (opt) {
+
+            //render backend
+            case 'r':
+                ret = rnd_select(optarg);
+                if (ret != 0) FATAL_FAIL(USAGE)
+                break;
+
+            //ROM extensions
+            case 'e':
+                ret = set_rom_exts(optarg);
+                if (ret != 0) FATAL_FAIL(USAGE)
+                break;
+
+            default:
+                FATAL_FAIL(USAGE)
+
+        } //end switch
+    }
+
+    return;
+}
+
+
+int main(int argc, char ** argv, char ** envp) {
+
+    //select the render backend
+    _parse_args(argc, argv);
 
     //drop root privileges
     //DEBUG _drop_privilege();
 
     //initialise core data
     init_subsys_state();
+    init_lat();
+    init_ev_loop(&_menu_loop);
+    _init_sources();
     init_udev();
-    init_roms();
-    init_js();
+    init_caps();
+    init_roms(&_menu_loop, _on_roms_change);
+    init_js(&_menu_loop, _on_js_change);
+    init_diag(&_menu_loop, _on_js_change);
+    init_stats(&_menu_loop, _on_stats_change);
     init_menu_state();
     init_execve_params(envp);
-    init_ncurses();
+    init_disp();
 
-    //draw the original menu
+    //draw the original menu, devices are published as they are found
     redraw();
     disp_refresh();
 
-    //main loop
-    prev = 0;
-    do {
-
-        //periodically update devices
-        now = time(NULL);
-        if ((now - prev) > 1) {
+    //sleep until input, a timer or a signal arrives
+    ev_run(&_menu_loop);
 
-            prev = now;
-            update_js_state();
-            //redraw();
-            //disp_refresh();
-        }
-
-        //process the next input
-        if (js_state.have_main_js == true
-            && js_state.input_failed == false) {
+    //release core data
+    fini_disp();
+    fini_stats();
+    fini_diag();
+    fini_js();
+    fini_roms();
+    fini_caps();
+    fini_udev();
+    fini_ev_loop(&_menu_loop);
 
-            ret = next_input(&in_event);
-            if (ret == 1) _dispatch_input(&in_event);
-        }
-        
-    } while (usleep(10000) || true); //always true
+    return 0;
 }
@@ -0,0 +1,1033 @@
+//C standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+//system headers
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+
+//external libraries
+#include <ncurses.h>
+
+//local headers
+#include "common.h"
+#include "render.h"
+
+
+/*
+ *  NOTE: The display draws to surfaces through one of these backends:
+ *
+ *        curses - ncurses on the controlling terminal.
+ *        ansi   - writes ANSI sequences for the cells that changed,
+ *                 without terminfo, for the boot tty. Starting it is
+ *                 a few writes rather than an initscr().
+ *        mem    - keeps the screen as a cell grid & writes nothing,
+ *                 to benchmark or inspect renders without a terminal.
+ *
+ *        The ansi & mem backends keep every surface as a cell grid &
+ *        the screen as the grid last shown. A flush compares the two,
+ *        so a surface switched to needs no touch. Moving a grid surface
+ *        clears it.
+ *
+ *        Rows are built once in the backend's own format, so the curses
+ *        backend converts cells to ncurses characters only when a row
+ *        changes rather than on every copy.
+ *
+ *        Terminal output is counted where a backend writes it. ncurses
+ *        writes to its file descriptor itself, bypassing stdio, so the
+ *        curses backend measures its output as the growth of the
+ *        calling thread's `wchar` I/O counter across a doupdate().
+ */
+
+
+// -- [macros] --
+
+//error strings
+#define ERR_CURSES "Ncurses encountered a fatal error."
+#define ERR_TERM "Failed to set up the terminal."
+#define ERR_ALLOC "Failed to allocate a render surface."
+
+//ANSI output buffer size & the longest sequence written at once
+#define ANSI_BUF_SZ 4096
+#define ANSI_SEQ_SZ 32
+
+//shortest run of blank cells erased rather than written
+#define ANSI_ERASE_MIN 8
+
+//I/O accounting of the calling thread & its read buffer size
+#define PATH_THREAD_IO "/proc/thread-self/io"
+#define IO_BUF_SZ 256
+
+
+// -- [data] --
+
+//backend operations
+struct rnd_backend {
+
+    const char * name;
+
+    void (* init)();
+    void (* fini)();
+    void (* resize)();
+
+    void (* new_surface)(struct rnd_surface * surface);
+    void (* del_surface)(struct rnd_surface * surface);
+    void (* move_surface)(struct rnd_surface * surface);
+    void (* erase_surface)(struct rnd_surface * surface);
+
+    void (* build_row)(struct rnd_row * row, const rnd_cell * cells);
+    int (* put)(struct rnd_surface * surface, int y, int x,
+                const struct rnd_row * row);
+    void (* touch)(struct rnd_surface * surface);
+    int (* flush)(struct rnd_surface * surface);
+
+    int64_t (* written)();
+};
+
+
+//screen shared by the backends
+struct rnd_screen {
+
+    int sz_y;
+    int sz_x;
+
+    rnd_cell bkgd;
+    struct rnd_pair pairs[RND_PAIR_NUM];
+
+    rnd_cell * cells; //ansi & mem backends: the cells last shown
+};
+
+
+//ANSI backend output state
+struct ansi_out {
+
+    //cursor position & colour pair of the terminal, -1 if unknown
+    int cur_y;
+    int cur_x;
+    int cur_pair;
+
+    //terminal settings to restore
+    bool has_termios;
+    struct termios termios;
+
+    //bytes written to the terminal
+    uint64_t written;
+
+    int buf_len;
+    char buf[ANSI_BUF_SZ];
+};
+
+
+//curses backend output state
+struct curses_out {
+
+    int io_fd; //-1 if I/O accounting is unavailable
+
+    //bytes written to the terminal
+    uint64_t written;
+};
+
+
+// -- [globals] --
+
+static struct rnd_screen _screen;
+static struct ansi_out _ansi_out;
+static struct curses_out _curses_out = {.io_fd = -1};
+
+//surfaces & cell grids allocated
+static uint64_t _alloc_count;
+
+//in-memory screen size
+static int _mem_sz_y = RND_MEM_SZ_Y;
+static int _mem_sz_x = RND_MEM_SZ_X;
+
+
+// -- [text] --
+
+//convert a cell to an ncurses character
+static chtype _curses_ch(rnd_cell cell) {
+
+    return (unsigned char) RND_CELL_CH(cell) | COLOR_PAIR(RND_CELL_PAIR(cell));
+}
+
+
+//start ncurses
+static void _curses_init() {
+
+    int ret;
+    void * ret_ptr;
+
+
+    //general setup
+    ret_ptr = initscr();
+    if (ret_ptr == NULL) FATAL_FAIL(ERR_CURSES)
+
+    ret = cbreak();
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    ret = keypad(stdscr, false);
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    ret = noecho();
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    ret = start_color();
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    //initialise colour pairs
+    for (int i = 1; i < RND_PAIR_NUM; ++i) {
+        ret = init_pair(i, _screen.pairs[i].fg, _screen.pairs[i].bg);
+        if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+    }
+
+    //setup root window
+    ret = bkgd(_curses_ch(_screen.bkgd));
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    getmaxyx(stdscr, _screen.sz_y, _screen.sz_x);
+
+    //measure output on the thread that will refresh
+    _curses_out.io_fd = open(PATH_THREAD_IO, O_RDONLY | O_CLOEXEC);
+
+    return;
+}
+
+
+//stop ncurses
+static void _curses_fini() {
+
+    int ret;
+
+
+    ret = endwin();
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    if (_curses_out.io_fd != -1) close(_curses_out.io_fd);
+    _curses_out.io_fd = -1;
+
+    return;
+}
+
+
+/*
+ *  NOTE: Signals are read from a signalfd, so ncurses never sees
+ *        SIGWINCH and the new terminal size is queried here instead.
+ */
+
+//adopt the new terminal size & clear the root window
+static void _curses_resize() {
+
+    int ret;
+    struct winsize ws;
+
+
+    ret = ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws);
+    if (ret == -1) FATAL_FAIL(ERR_CURSES)
+
+    ret = resizeterm(ws.ws_row, ws.ws_col);
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    getmaxyx(stdscr, _screen.sz_y, _screen.sz_x);
+
+    //clear what the windows left behind on the root window
+    ret = erase();
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+    ret = wnoutrefresh(stdscr);
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    return;
+}
+
+
+//create a window
+static void _curses_new_surface(struct rnd_surface * surface) {
+
+    int ret;
+    WINDOW * win;
+
+
+    win = newwin(surface->sz_y, surface->sz_x, surface->y, surface->x);
+    if (win == NULL) FATAL_FAIL(ERR_CURSES)
+
+    ret = wbkgd(win, _curses_ch(surface->bkgd));
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    surface->win = win;
+    return;
+}
+
+
+//release a window
+static void _curses_del_surface(struct rnd_surface * surface) {
+
+    int ret;
+
+
+    ret = delwin(surface->win);
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+    surface->win = NULL;
+
+    return;
+}
+
+
+//move & resize a window
+static void _curses_move_surface(struct rnd_surface * surface) {
+
+    int ret;
+
+
+    //resize first, the new size always fits at the new position
+    ret = wresize(surface->win, surface->sz_y, surface->sz_x);
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    ret = mvwin(surface->win, surface->y, surface->x);
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    return;
+}
+
+
+//clear a window
+static void _curses_erase(struct rnd_surface * surface) {
+
+    int ret;
+
+
+    ret = werase(surface->win);
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    return;
+}
+
+
+//convert cells to a row of ncurses characters
+static void _curses_build_row(struct rnd_row * row, const rnd_cell * cells) {
+
+    for (int i = 0; i < row->len; ++i) row->chs[i] = _curses_ch(cells[i]);
+    return;
+}
+
+
+//copy a row to a window
+static int _curses_put(struct rnd_surface * surface, int y, int x,
+                       const struct rnd_row * row) {
+
+    int ret;
+
+
+    ret = mvwaddchnstr(surface->win, y, x, row->chs, row->len);
+    return (ret == ERR) ? -1 : 0;
+}
+
+
+//copy a window to the screen whole on the next refresh
+static void _curses_touch(struct rnd_surface * surface) {
+
+    int ret;
+
+
+    ret = touchwin((WINDOW *) surface->win);
+    if (ret == ERR) FATAL_FAIL(ERR_CURSES)
+
+    return;
+}
+
+
+//get the bytes the calling thread wrote so far, 0 if it can't be read
+static uint64_t _curses_read_wchar() {
+
+    ssize_t ret;
+    char buf[IO_BUF_SZ], * line;
+
+
+    //the counters are regenerated on every read from the start
+    ret = pread(_curses_out.io_fd, buf, IO_BUF_SZ - 1, 0);
+    if (ret <= 0) return 0;
+    buf[ret] = '\0';
+
+    line = strstr(buf, "wchar:");
+    if (line == NULL) return 0;
+
+    return strtoull(line + 6, NULL, 10);
+}
+
+
+//stage the window & write all staged changes at once
+static int _curses_flush(struct rnd_surface * surface) {
+
+    int ret;
+    uint64_t start, end;
+
+
+    ret = wnoutrefresh(surface->win);
+    if (ret == ERR) return -1;
+
+    //nothing else writes on this thread during the update
+    start = (_curses_out.io_fd == -1) ? 0 : _curses_read_wchar();
+    ret = doupdate();
+    if (ret == ERR) return -1;
+    end = (_curses_out.io_fd == -1) ? 0 : _curses_read_wchar();
+
+    if (end > start) _curses_out.written += end - start;
+
+    return 0;
+}
+
+
+//get the bytes written to the terminal so far, -1 without I/O accounting
+static int64_t _curses_written() {
+
+    return (_curses_out.io_fd == -1) ? -1 : (int64_t) _curses_out.written;
+}
+
+
+//fill `num` cells
+static void _fill_cells(rnd_cell * cells, int num, rnd_cell cell) {
+
+    for (int i = 0; i < num; ++i) cells[i] = cell;
+    return;
+}
+
+
+//allocate the screen grid at its current size, filled with the background
+static void _grid_alloc_screen() {
+
+    free(_screen.cells);
+    _screen.cells = malloc(sizeof(rnd_cell) * _screen.sz_y * _screen.sz_x);
+    if (_screen.cells == NULL) FATAL_FAIL(ERR_ALLOC)
+    _alloc_count += 1;
+
+    _fill_cells(_screen.cells, _screen.sz_y * _screen.sz_x, _screen.bkgd);
+
+    return;
+}
+
+
+//allocate a surface grid, filled with its background
+static void _grid_new_surface(struct rnd_surface * surface) {
+
+    surface->cells = malloc(sizeof(rnd_cell) * surface->sz_y * surface->sz_x);
+    if (surface->cells == NULL) FATAL_FAIL(ERR_ALLOC)
+    _alloc_count += 1;
+
+    _fill_cells(surface->cells, surface->sz_y * surface->sz_x, surface->bkgd);
+
+    return;
+}
+
+
+//release a surface grid
+static void _grid_del_surface(struct rnd_surface * surface) {
+
+    free(surface->cells);
+    surface->cells = NULL;
+
+    return;
+}
+
+
+//reallocate a surface grid for its new size
+static void _grid_move_surface(struct rnd_surface * surface) {
+
+    _grid_del_surface(surface);
+    _grid_new_surface(surface);
+
+    return;
+}
+
+
+//fill a surface grid with its background
+static void _grid_erase(struct rnd_surface * surface) {
+
+    _fill_cells(surface->cells, surface->sz_y * surface->sz_x, surface->bkgd);
+    return;
+}
+
+
+//keep cells as they are for a surface grid
+static void _grid_build_row(struct rnd_row * row, const rnd_cell * cells) {
+
+    memcpy(row->cells, cells, sizeof(rnd_cell) * row->len);
+    return;
+}
+
+
+//copy a row to a surface grid, clipped to its right edge
+static int _grid_put(struct rnd_surface * surface, int y, int x,
+                     const struct rnd_row * row) {
+
+    int len;
+
+
+    if (y < 0 || y >= surface->sz_y || x < 0 || x >= surface->sz_x)
+        return -1;
+    len = (row->len > surface->sz_x - x) ? surface->sz_x - x : row->len;
+
+    memcpy(surface->cells + (y * surface->sz_x) + x,
+           row->cells, sizeof(rnd_cell) * len);
+
+    return 0;
+}
+
+
+//flushes compare every cell, a switched to surface needs no touch
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _grid_touch(struct rnd_surface * surface) {
+#pragma GCC diagnostic pop
+
+    return;
+}
+
+
+//start the in-memory screen
+static void _mem_init() {
+
+    _screen.sz_y = _mem_sz_y;
+    _screen.sz_x = _mem_sz_x;
+    _grid_alloc_screen();
+
+    return;
+}
+
+
+//release the in-memory screen
+static void _mem_fini() {
+
+    free(_screen.cells);
+    _screen.cells = NULL;
+
+    return;
+}
+
+
+//clear the in-memory screen, its size never changes
+static void _mem_resize() {
+
+    _grid_alloc_screen();
+    return;
+}
+
+
+//copy a surface to the in-memory screen
+static int _mem_flush(struct rnd_surface * surface) {
+
+    int len;
+
+
+    //clip the surface to the screen
+    if (surface->x < 0 || surface->x >= _screen.sz_x) return 0;
+    len = surface->sz_x;
+    if (len > _screen.sz_x - surface->x) len = _screen.sz_x - surface->x;
+
+    for (int i = 0; i < surface->sz_y; ++i) {
+
+        if (surface->y + i < 0 || surface->y + i >= _screen.sz_y) continue;
+        memcpy(_screen.cells + ((surface->y + i) * _screen.sz_x)
+                             + surface->x,
+               surface->cells + (i * surface->sz_x), sizeof(rnd_cell) * len);
+    }
+
+    return 0;
+}
+
+
+//the in-memory screen writes nothing
+static int64_t _mem_written() {
+
+    return 0;
+}
+
+
+//write the buffered ANSI output to the terminal
+static int _ansi_drain() {
+
+    ssize_t ret;
+    int off;
+
+
+    off = 0;
+    while (off < _ansi_out.buf_len) {
+
+        ret = write(STDOUT_FILENO, _ansi_out.buf + off,
+                    _ansi_out.buf_len - off);
+        if (ret == -1 && errno == EINTR) continue;
+        if (ret == -1) {
+            _ansi_out.buf_len = 0;
+            return -1;
+        }
+        off += ret;
+        _ansi_out.written += ret;
+    }
+    _ansi_out.buf_len = 0;
+
+    return 0;
+}
+
+
+//buffer ANSI output, writing it out when the buffer fills
+static int _ansi_write(const char * str, int len) {
+
+    int ret;
+
+
+    if (_ansi_out.buf_len + len > ANSI_BUF_SZ) {
+        ret = _ansi_drain();
+        if (ret != 0) return -1;
+    }
+
+    memcpy(_ansi_out.buf + _ansi_out.buf_len, str, len);
+    _ansi_out.buf_len += len;
+
+    return 0;
+}
+
+
+//buffer an ANSI sequence selecting a colour pair
+static int _ansi_write_pair(int pair) {
+
+    int len;
+    char seq[ANSI_SEQ_SZ];
+
+
+    if (pair == 0) {
+        len = snprintf(seq, ANSI_SEQ_SZ, "\x1b[0m");
+    } else {
+        len = snprintf(seq, ANSI_SEQ_SZ, "\x1b[3%d;4%dm",
+                       _screen.pairs[pair].fg, _screen.pairs[pair].bg);
+    }
+    _ansi_out.cur_pair = pair;
+
+    return _ansi_write(seq, len);
+}
+
+
+//query the terminal size & clear the terminal to the background
+static int _ansi_clear() {
+
+    int ret;
+    struct winsize ws;
+
+
+    ret = ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws);
+    if (ret == -1) FATAL_FAIL(ERR_TERM)
+
+    _screen.sz_y = ws.ws_row;
+    _screen.sz_x = ws.ws_col;
+    _grid_alloc_screen();
+
+    //erasing fills the screen with the current background colour
+    ret = _ansi_write_pair(RND_CELL_PAIR(_screen.bkgd));
+    if (ret != 0) return -1;
+    ret = _ansi_write("\x1b[2J", 4);
+    if (ret != 0) return -1;
+
+    //the next cell drawn positions the cursor
+    _ansi_out.cur_y = -1;
+    _ansi_out.cur_x = -1;
+
+    return _ansi_drain();
+}
+
+
+//take over the terminal
+static void _ansi_init() {
+
+    int ret;
+    struct termios termios;
+
+
+    //stop keys typed on the terminal from echoing over the menu
+    ret = tcgetattr(STDIN_FILENO, &_ansi_out.termios);
+    _ansi_out.has_termios = (ret == 0);
+    if (_ansi_out.has_termios == true) {
+
+        termios = _ansi_out.termios;
+        termios.c_lflag &= ~(ECHO | ICANON);
+        ret = tcsetattr(STDIN_FILENO, TCSANOW, &termios);
+        if (ret == -1) FATAL_FAIL(ERR_TERM)
+    }
+
+    //switch to the alternate screen & hide the cursor
+    _ansi_out.buf_len = 0;
+    ret = _ansi_write("\x1b[?1049h\x1b[?25l", 14);
+    if (ret != 0) FATAL_FAIL(ERR_TERM)
+
+    ret = _ansi_clear();
+    if (ret != 0) FATAL_FAIL(ERR_TERM)
+
+    return;
+}
+
+
+//give the terminal back as it was found
+static void _ansi_fini() {
+
+    int ret;
+
+
+    ret = _ansi_write("\x1b[0m\x1b[?25h\x1b[?1049l", 18);
+    if (ret == 0) ret = _ansi_drain();
+    if (ret != 0) FATAL_FAIL(ERR_TERM)
+
+    if (_ansi_out.has_termios == true) {
+        ret = tcsetattr(STDIN_FILENO, TCSANOW, &_ansi_out.termios);
+        if (ret == -1) FATAL_FAIL(ERR_TERM)
+    }
+
+    free(_screen.cells);
+    _screen.cells = NULL;
+
+    return;
+}
+
+
+//adopt the new terminal size
+static void _ansi_resize() {
+
+    int ret;
+
+
+    ret = _ansi_clear();
+    if (ret != 0) FATAL_FAIL(ERR_TERM)
+
+    return;
+}
+
+
+//get the length of the run of `cell` at `x` of surface row `y`
+static int _ansi_run_len(struct rnd_surface * surface,
+                         int y, int x, rnd_cell cell) {
+
+    int len, max_len;
+    rnd_cell * row;
+
+
+    //runs end at the right edge of the surface & of the screen
+    max_len = surface->sz_x - x;
+    if (max_len > _screen.sz_x - (surface->x + x))
+        max_len = _screen.sz_x - (surface->x + x);
+
+    row = surface->cells + (y * surface->sz_x);
+    for (len = 1; len < max_len && row[x + len] == cell; ++len);
+
+    return len;
+}
+
+
+//write the cells of a surface the terminal doesn't show yet
+static int _ansi_flush(struct rnd_surface * surface) {
+
+    int ret, len, run;
+    int y, x;
+
+    rnd_cell cell;
+    rnd_cell * shown;
+    char seq[ANSI_SEQ_SZ], ch;
+
+
+    for (int i = 0; i < surface->sz_y; ++i) {
+
+        y = surface->y + i;
+        if (y < 0 || y >= _screen.sz_y) continue;
+
+        for (int j = 0; j < surface->sz_x; ++j) {
+
+            x = surface->x + j;
+            if (x < 0 || x >= _screen.sz_x) continue;
+
+            cell  = surface->cells[(i * surface->sz_x) + j];
+            shown = _screen.cells + (y * _screen.sz_x) + x;
+            if (*shown == cell) continue;
+
+            //move the cursor unless the last cell left it here
+            if (_ansi_out.cur_y != y || _ansi_out.cur_x != x) {
+                len = snprintf(seq, ANSI_SEQ_SZ, "\x1b[%d;%dH", y + 1, x + 1);
+                ret = _ansi_write(seq, len);
+                if (ret != 0) return -1;
+            }
+
+            if (_ansi_out.cur_pair != RND_CELL_PAIR(cell)) {
+                ret = _ansi_write_pair(RND_CELL_PAIR(cell));
+                if (ret != 0) return -1;
+            }
+
+            //erase long blank runs in the current colour, in place
+            run = (RND_CELL_CH(cell) == ' ')
+                  ? _ansi_run_len(surface, i, j, cell) : 1;
+            if (run >= ANSI_ERASE_MIN) {
+
+                len = snprintf(seq, ANSI_SEQ_SZ, "\x1b[%dX", run);
+                ret = _ansi_write(seq, len);
+                if (ret != 0) return -1;
+
+                _fill_cells(shown, run, cell);
+                _ansi_out.cur_y = y;
+                _ansi_out.cur_x = x;
+                j += run - 1;
+                continue;
+            }
+
+            ch = RND_CELL_CH(cell);
+            ret = _ansi_write(&ch, 1);
+            if (ret != 0) return -1;
+            *shown = cell;
+
+            //past the last column the cursor position is unknown
+            _ansi_out.cur_y = (x + 1 == _screen.sz_x) ? -1 : y;
+            _ansi_out.cur_x = x + 1;
+        }
+    }
+
+    return _ansi_drain();
+}
+
+
+//get the bytes written to the terminal so far
+static int64_t _ansi_written() {
+
+    return (int64_t) _ansi_out.written;
+}
+
+
+//render backends
+static const struct rnd_backend _backends[] = {
+    {
+        .name          = "curses",
+        .init          = _curses_init,
+        .fini          = _curses_fini,
+        .resize        = _curses_resize,
+        .new_surface   = _curses_new_surface,
+        .del_surface   = _curses_del_surface,
+        .move_surface  = _curses_move_surface,
+        .erase_surface = _curses_erase,
+        .build_row     = _curses_build_row,
+        .put           = _curses_put,
+        .touch         = _curses_touch,
+        .flush         = _curses_flush,
+        .written       = _curses_written
+    },
+    {
+        .name          = "ansi",
+        .init          = _ansi_init,
+        .fini          = _ansi_fini,
+        .resize        = _ansi_resize,
+        .new_surface   = _grid_new_surface,
+        .del_surface   = _grid_del_surface,
+        .move_surface  = _grid_move_surface,
+        .erase_surface = _grid_erase,
+        .build_row     = _grid_build_row,
+        .put           = _grid_put,
+        .touch         = _grid_touch,
+        .flush         = _ansi_flush,
+        .written       = _ansi_written
+    },
+    {
+        .name          = "mem",
+        .init          = _mem_init,
+        .fini          = _mem_fini,
+        .resize        = _mem_resize,
+        .new_surface   = _grid_new_surface,
+        .del_surface   = _grid_del_surface,
+        .move_surface  = _grid_move_surface,
+        .erase_surface = _grid_erase,
+        .build_row     = _grid_build_row,
+        .put           = _grid_put,
+        .touch         = _grid_touch,
+        .flush         = _mem_flush,
+        .written       = _mem_written
+    }
+};
+
+//selected backend
+static const struct rnd_backend * _backend = &_backends[0];
+
+
+//select the backend by name before initialising, return 0 on success
+int rnd_select(const char * name) {
+
+    for (size_t i = 0; i < sizeof(_backends) / sizeof(_backends[0]); ++i) {
+
+        if (strcmp(_backends[i].name, name) != 0) continue;
+        _backend = &_backends[i];
+        return 0;
+    }
+
+    return -1;
+}
+
+
+//get the name of the selected backend
+const char * rnd_name() {
+
+    return _backend->name;
+}
+
+
+//set the size of the in-memory screen, before initialising
+void rnd_mem_set_size(int sz_y, int sz_x) {
+
+    _mem_sz_y = sz_y;
+    _mem_sz_x = sz_x;
+
+    return;
+}
+
+
+//get the in-memory screen, row by row
+const rnd_cell * rnd_mem_screen(int * sz_y, int * sz_x) {
+
+    *sz_y = _screen.sz_y;
+    *sz_x = _screen.sz_x;
+
+    return _screen.cells;
+}
+
+
+//initialise the selected backend
+void init_render(const struct rnd_pair * pairs, rnd_cell bkgd) {
+
+    memcpy(_screen.pairs, pairs, sizeof(_screen.pairs));
+    _screen.bkgd = bkgd;
+    _backend->init();
+
+    return;
+}
+
+
+//release the selected backend
+void fini_render() {
+
+    _backend->fini();
+    return;
+}
+
+
+//get the screen size
+void rnd_get_size(int * sz_y, int * sz_x) {
+
+    *sz_y = _screen.sz_y;
+    *sz_x = _screen.sz_x;
+
+    return;
+}
+
+
+//adopt a new terminal size, clearing the screen
+void rnd_resize() {
+
+    _backend->resize();
+    return;
+}
+
+
+//create a surface
+struct rnd_surface * rnd_new_surface(int y, int x, int sz_y, int sz_x,
+                                     rnd_cell bkgd) {
+
+    struct rnd_surface * surface;
+
+
+    surface = malloc(sizeof(*surface));
+    if (surface == NULL) FATAL_FAIL(ERR_ALLOC)
+    _alloc_count += 1;
+
+    surface->y     = y;
+    surface->x     = x;
+    surface->sz_y  = sz_y;
+    surface->sz_x  = sz_x;
+    surface->bkgd  = bkgd;
+    surface->win   = NULL;
+    surface->cells = NULL;
+
+    _backend->new_surface(surface);
+
+    return surface;
+}
+
+
+//release a surface
+void rnd_del_surface(struct rnd_surface * surface) {
+
+    _backend->del_surface(surface);
+    free(surface);
+
+    return;
+}
+
+
+//move & resize a surface
+void rnd_move_surface(struct rnd_surface * surface,
+                      int y, int x, int sz_y, int sz_x) {
+
+    surface->y    = y;
+    surface->x    = x;
+    surface->sz_y = sz_y;
+    surface->sz_x = sz_x;
+
+    _backend->move_surface(surface);
+
+    return;
+}
+
+
+//fill a surface with its background
+void rnd_erase(struct rnd_surface * surface) {
+
+    _backend->erase_surface(surface);
+    return;
+}
+
+
+//build a row of up to RND_ROW_SZ cells in the selected backend's format
+void rnd_build_row(struct rnd_row * row, const rnd_cell * cells, int len) {
+
+    row->len = (len > RND_ROW_SZ) ? RND_ROW_SZ : len;
+    _backend->build_row(row, cells);
+
+    return;
+}
+
+
+//copy a built row to a surface, return 0 on success
+int rnd_put(struct rnd_surface * surface, int y, int x,
+            const struct rnd_row * row) {
+
+    return _backend->put(surface, y, x, row);
+}
+
+
+//copy a surface to the screen whole on the next flush
+void rnd_touch(struct rnd_surface * surface) {
+
+    _backend->touch(surface);
+    return;
+}
+
+
+//show what changed on a surface, return 0 on success
+int rnd_flush(struct rnd_surface * surface) {
+
+    return _backend->flush(surface);
+}
+
+
+//get the bytes written to the terminal so far, -1 if the backend can't tell
+int64_t rnd_written() {
+
+    return _backend->written();
+}
+
+
+//get the surfaces & cell grids allocated so far
+uint64_t rnd_alloc_count() {
+
+    return _alloc_count;
+}
@@ -0,0 +1,137 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+//C standard library
+#include <stdint.h>
+
+
+// -- [macros] --
+
+//colours, the same numbers as ANSI & ncurses colours
+#define RND_BLACK   0
+#define RND_RED     1
+#define RND_GREEN   2
+#define RND_YELLOW  3
+#define RND_BLUE    4
+#define RND_MAGENTA 5
+#define RND_CYAN    6
+#define RND_WHITE   7
+
+//colour pair count, pair 0 is the terminal default
+#define RND_PAIR_NUM 8
+
+//build & split an attributed cell
+#define RND_CELL(ch, pair) \
+    ((rnd_cell) (((pair) << 8) | (unsigned char) (ch)))
+#define RND_CELL_CH(cell) ((char) ((cell) & 0xff))
+#define RND_CELL_PAIR(cell) ((cell) >> 8)
+
+//widest row of cells built at once
+#define RND_ROW_SZ 96
+
+//default in-memory screen size
+#define RND_MEM_SZ_Y 24
+#define RND_MEM_SZ_X 80
+
+
+// -- [data] --
+
+//a character & its colour pair
+typedef uint16_t rnd_cell;
+
+//a character of the curses backend, an ncurses chtype
+typedef uint32_t rnd_ch;
+
+
+//a row of cells in the selected backend's own format, built once &
+//copied to surfaces as is
+struct rnd_row {
+
+    int len;
+
+    union {
+        rnd_cell cells[RND_ROW_SZ]; //ansi & mem backends
+        rnd_ch chs[RND_ROW_SZ];     //curses backend
+    };
+};
+
+
+//foreground & background of a colour pair
+struct rnd_pair {
+
+    short fg;
+    short bg;
+};
+
+
+//rectangle of the screen drawn to as a whole
+struct rnd_surface {
+
+    //position & size on the screen
+    int y;
+    int x;
+    int sz_y;
+    int sz_x;
+
+    rnd_cell bkgd;
+
+    void * win;       //ncurses backend: the WINDOW
+    rnd_cell * cells; //other backends: `sz_y` rows of `sz_x` cells
+};
+
+
+// -- [text] --
+
+//select the backend by name before initialising, return 0 on success
+int rnd_select(const char * name);
+
+//get the name of the selected backend
+const char * rnd_name();
+
+//set the size of the in-memory screen, before initialising
+void rnd_mem_set_size(int sz_y, int sz_x);
+
+//get the in-memory screen, row by row
+const rnd_cell * rnd_mem_screen(int * sz_y, int * sz_x);
+
+//initialise & release the selected backend, `pairs` has RND_PAIR_NUM pairs
+void init_render(const struct rnd_pair * pairs, rnd_cell bkgd);
+void fini_render();
+
+//get the screen size
+void rnd_get_size(int * sz_y, int * sz_x);
+
+//adopt a new terminal size, clearing the screen
+void rnd_resize();
+
+//create, release, move & resize a surface
+struct rnd_surface * rnd_new_surface(int y, int x, int sz_y, int sz_x,
+                                     rnd_cell bkgd);
+void rnd_del_surface(struct rnd_surface * surface);
+void rnd_move_surface(struct rnd_surface * surface,
+                      int y, int x, int sz_y, int sz_x);
+
+//fill a surface with its background
+void rnd_erase(struct rnd_surface * surface);
+
+//build a row of up to RND_ROW_SZ cells in the selected backend's format
+void rnd_build_row(struct rnd_row * row, const rnd_cell * cells, int len);
+
+//copy a built row to a surface, return 0 on success
+int rnd_put(struct rnd_surface * surface, int y, int x,
+            const struct rnd_row * row);
+
+//copy a surface to the screen whole on the next flush
+void rnd_touch(struct rnd_surface * surface);
+
+//show what changed on a surface, return 0 on success
+int rnd_flush(struct rnd_surface * surface);
+
+//get the bytes written to the terminal so far, -1 if the backend can't tell
+int64_t rnd_written();
+
+//get the surfaces & cell grids allocated so far
+uint64_t rnd_alloc_count();
+
+
+#endif
@@ -0,0 +1,82 @@
+//C standard library
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <string.h>
+
+//local headers
+#include "common.h"
+#include "ring.h"
+
+
+/*
+ *  NOTE: Indices increase forever & are masked on access, so a full
+ *        ring is `tail - head == len` & no slot is wasted. Each side
+ *        only writes its own index; the release store of that index
+ *        publishes the entry (or frees its slot) to the other side's
+ *        acquire load.
+ */
+
+// -- [text] --
+
+//initialise a ring, `len` must be a power of two
+void init_ring(struct spsc_ring * ring, size_t len, size_t entry_sz) {
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+
+    ring->mask     = len - 1;
+    ring->entry_sz = entry_sz;
+
+    ring->entries = malloc(len * entry_sz);
+    if (ring->entries == NULL) FATAL_FAIL("Failed to allocate a ring.")
+
+    return;
+}
+
+
+//release a ring
+void fini_ring(struct spsc_ring * ring) {
+
+    free(ring->entries);
+    ring->entries = NULL;
+
+    return;
+}
+
+
+//append an entry from the producer, returns false if the ring is full
+bool ring_push(struct spsc_ring * ring, const void * entry) {
+
+    size_t head, tail;
+
+
+    tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail - head > ring->mask) return false;
+
+    memcpy(ring->entries + (tail & ring->mask) * ring->entry_sz,
+           entry, ring->entry_sz);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+
+//remove the oldest entry from the consumer, returns false if it's empty
+bool ring_pop(struct spsc_ring * ring, void * entry) {
+
+    size_t head, tail;
+
+
+    head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head == tail) return false;
+
+    memcpy(entry, ring->entries + (head & ring->mask) * ring->entry_sz,
+           ring->entry_sz);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    return true;
+}
@@ -0,0 +1,47 @@
+#ifndef RING_H
+#define RING_H
+
+//C standard library
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+
+// -- [macros] --
+
+//cache line size, keeps producer & consumer indices apart
+#define RING_LINE_SZ 64
+
+
+// -- [data] --
+
+//lock-free single producer, single consumer ring of fixed size entries
+struct spsc_ring {
+
+    //written by the consumer
+    _Alignas(RING_LINE_SZ) atomic_size_t head;
+
+    //written by the producer
+    _Alignas(RING_LINE_SZ) atomic_size_t tail;
+
+    //read-only after initialisation
+    _Alignas(RING_LINE_SZ) size_t mask;
+    size_t entry_sz;
+    char * entries;
+};
+
+
+// -- [text] --
+
+//initialise & release a ring, `len` must be a power of two
+void init_ring(struct spsc_ring * ring, size_t len, size_t entry_sz);
+void fini_ring(struct spsc_ring * ring);
+
+//append an entry from the producer, returns false if the ring is full
+bool ring_push(struct spsc_ring * ring, const void * entry);
+
+//remove the oldest entry from the consumer, returns false if it's empty
+bool ring_pop(struct spsc_ring * ring, void * entry);
+
+
+#endif
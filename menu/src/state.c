@@ -1,12 +1,15 @@
 //C standard library
 #include <stdlib.h>
+#include <string.h>
 
-//external libraries
-#include <ncurses.h>
+//system headers
+#include <unistd.h>
 
 //local headers
 #include "data.h"
+#include "diag.h"
 #include "display.h"
+#include "event.h"
 #include "input.h"
 #include "state.h"
 
@@ -29,6 +32,7 @@ void init_menu_state() {
     //set window meta-data
     menu_state.current_win = MAIN;
     menu_state.current_win_ptr = NULL;
+    menu_state.needs_redraw = false;
 
     //set main menu data
     menu_state.main_menu_pos = 0;
@@ -36,11 +40,15 @@ void init_menu_state() {
     //set ROMs menu data
     menu_state.roms_menu_pos = 0;
     menu_state.roms_menu_off = 0;
+    menu_state.roms_menu_sel[0] = '\0';
 
     //set info menu data
     menu_state.info_menu_pos = 0;
     menu_state.info_menu_off = 0;
 
+    //set diagnostics menu data
+    menu_state.diag_menu_pos = 0;
+
     return;
 }
 
@@ -53,19 +61,121 @@ void init_execve_params(char ** own_envp) {
 }
 
 
+//remember the selected item, so list changes can't move the selection off it
+static void _track_roms_sel() {
+
+    int ret, name_len;
+    const char * name;
+    struct rom_item item;
+
+
+    ret = get_rom_item(menu_state.roms_menu_pos - ROMS_MENU_OPTS, &item);
+    if (ret != 0) {
+        menu_state.roms_menu_sel[0] = '\0';
+    } else {
+        //a name that doesn't fit can't be searched for, so isn't followed
+        name = get_rom_item_name(&item, &name_len);
+        if (name_len >= (int) sizeof(menu_state.roms_menu_sel)) name_len = 0;
+        memcpy(menu_state.roms_menu_sel, name, name_len);
+        menu_state.roms_menu_sel[name_len] = '\0';
+    }
+
+    return;
+}
+
+
+//open a folder of the ROMs window, selecting the item `sel` or the first
+static void _open_roms_folder(const char * folder, const char * sel) {
+
+    int item_idx;
+
+
+    open_rom_folder(folder);
+
+    //an item that's gone leaves the selection on "BACK"
+    item_idx = (sel == NULL) ? 0 : find_rom_item(sel);
+    menu_state.roms_menu_pos
+        = int_clamp(ROMS_MENU_OPTS + item_idx, 0,
+                    ROMS_MENU_OPTS + count_rom_items() - 1);
+    _track_roms_sel();
+    disp_roms_folder();
+
+    return;
+}
+
+
+//open a subfolder of the ROMs window's folder
+static void _enter_roms_folder(const struct rom_item * item) {
+
+    int name_len;
+    size_t len;
+    const char * name;
+    char folder[PATH_MAX];
+
+
+    //the subfolder's path is a prefix of its ROMs' paths, so it should fit
+    name = get_rom_item_name(item, &name_len);
+    len  = strnlen(rom_folder, sizeof(rom_folder));
+    if (len + name_len >= sizeof(folder)) return;
+
+    memcpy(folder, rom_folder, len);
+    memcpy(folder + len, name, name_len);
+    folder[len + name_len] = '\0';
+
+    _open_roms_folder(folder, NULL);
+
+    return;
+}
+
+
+//open the parent of the ROMs window's folder, selecting the folder left
+static void _leave_roms_folder() {
+
+    size_t len, name_len;
+    char * name;
+    char folder[PATH_MAX], sel[PATH_MAX];
+
+
+    //the folder ends in '/', its name starts after the '/' before it
+    len = strnlen(rom_folder, sizeof(rom_folder));
+    if (len == 0 || len == sizeof(folder)) return;
+    memcpy(folder, rom_folder, len);
+    folder[len - 1] = '\0';
+
+    //the name & its '/' fit, they're shorter than the folder
+    name = strrchr(folder, '/');
+    name = (name == NULL) ? folder : name + 1;
+    name_len = strnlen(name, sizeof(sel) - 2);
+    memcpy(sel, name, name_len);
+    sel[name_len]     = '/';
+    sel[name_len + 1] = '\0';
+    *name = '\0';
+
+    _open_roms_folder(folder, sel);
+
+    return;
+}
+
+
 //handle window entry or ROM launch
 void handle_activate() {
 
+    int ret;
+    struct rom_item item;
+
+
     //main menu case
     if (menu_state.current_win == MAIN) {
 
         switch(menu_state.main_menu_pos) {
         case 0: //PLAY
             disp_main_exit();
+            open_rom_folder("");
             disp_roms_entry();
             menu_state.current_win = ROMS;
             menu_state.roms_menu_pos = 0;
             menu_state.roms_menu_off = 0;
+            menu_state.roms_menu_sel[0] = '\0';
             break;
 
         case 1: //INFO
@@ -73,8 +183,17 @@ void handle_activate() {
             disp_info_entry();
             menu_state.current_win = INFO;
             menu_state.info_menu_pos = 0;
+            break;
 
-        case 2: //EXIT
+        case 2: //DIAG
+            disp_main_exit();
+            diag_start();
+            disp_diag_entry();
+            menu_state.current_win = DIAG;
+            menu_state.diag_menu_pos = 0;
+            break;
+
+        case 3: //EXIT
             //system("systemctl poweroff");
             break;
         }
@@ -88,22 +207,30 @@ void handle_activate() {
                 break;
 
             default:
+                ret = get_rom_item(menu_state.roms_menu_pos - ROMS_MENU_OPTS,
+                                   &item);
+
+                //folders are opened in place
+                if (ret == 0 && item.is_dir == true) {
+                    _enter_roms_folder(&item);
+                    break;
+                }
+
                 //TODO launch ROM
-                fini_ncurses();
+                //the emulator must not inherit the menu's blocked signals
+                fini_disp();
+                ev_unblock_signals();
                 execve("/asdiandsnadiansd", argv, envp); //DEBUG
 
                 // -- if we reached here, execve failed
 
-                //re-initialise ncurses
-                init_ncurses();
+                //re-initialise the display & signal routing
+                ev_block_signals();
+                init_disp();
 
-                //tell ncurses to draw the ROMs menu
+                //draw the ROMs menu
                 disp_roms_entry();
 
-                //redraw
-                redraw();
-                disp_refresh();
-
                 //note that execve failed
                 subsys_state.execve_good = false;
                 break;
@@ -116,11 +243,15 @@ void handle_activate() {
         disp_main_entry();
         menu_state.current_win = MAIN;
         menu_state.main_menu_pos = 1;
+
+    //diagnostics menu case
+    } else if (menu_state.current_win == DIAG) {
+
+        handle_exit();
         
     } //end if
 
-    redraw();
-    disp_refresh();
+    menu_state.needs_redraw = true;
     return;
 }
 
@@ -131,10 +262,15 @@ void handle_exit() {
     //ROMs menu case
     if (menu_state.current_win == ROMS) {
 
-        disp_roms_exit();
-        disp_main_entry();
-        menu_state.current_win = MAIN;
-        menu_state.main_menu_pos = 0;
+        //a subfolder is left for its parent first
+        if (rom_folder[0] != '\0') {
+            _leave_roms_folder();
+        } else {
+            disp_roms_exit();
+            disp_main_entry();
+            menu_state.current_win = MAIN;
+            menu_state.main_menu_pos = 0;
+        }
 
     //info menu case
     } else if (menu_state.current_win == INFO) {
@@ -144,71 +280,149 @@ void handle_exit() {
         menu_state.current_win = MAIN;
         menu_state.main_menu_pos = 1;
 
+    //diagnostics menu case
+    } else if (menu_state.current_win == DIAG) {
+
+        diag_stop();
+        disp_diag_exit();
+        disp_main_entry();
+        menu_state.current_win = MAIN;
+        menu_state.main_menu_pos = 2;
+
     } //end if
 
-    redraw();
-    disp_refresh();
+    menu_state.needs_redraw = true;
     return;
 }
 
 
-//handle a down input
-void handle_down() {
+//move the selection one entry down, returns false at the bottom
+static bool _move_down() {
+
+    int prev_pos;
     
     //main menu case
     if (menu_state.current_win == MAIN) {
 
+        prev_pos = menu_state.main_menu_pos;
         disp_main_down();
         if (menu_state.main_menu_pos != (MAIN_MENU_OPTS - 1))
             menu_state.main_menu_pos += 1;
+        return prev_pos != menu_state.main_menu_pos;
 
     //ROMs menu case
     } else if (menu_state.current_win == ROMS) {
 
+        prev_pos = menu_state.roms_menu_pos;
         disp_roms_down();
         if (menu_state.roms_menu_pos
-            != (ROMS_MENU_OPTS + rom_basenames.len - 1))
+            != (ROMS_MENU_OPTS + count_rom_items() - 1))
             menu_state.roms_menu_pos += 1;
+        return prev_pos != menu_state.roms_menu_pos;
 
     //info menu case
     } else if (menu_state.current_win == INFO) {
 
-        disp_info_down();
+        return disp_info_down();
+
+    //diagnostics menu case
+    } else if (menu_state.current_win == DIAG) {
+
+        return disp_diag_down();
 
     } //end if
 
-    redraw();
-    disp_refresh();
-    return;
+    return false;
 }
 
 
-//handle an up input
-void handle_up() {
+//move the selection one entry up, returns false at the top
+static bool _move_up() {
+
+    int prev_pos;
     
     //main menu case
     if (menu_state.current_win == MAIN) {
 
+        prev_pos = menu_state.main_menu_pos;
         disp_main_up();
         if (menu_state.main_menu_pos != 0)
             menu_state.main_menu_pos -= 1;
+        return prev_pos != menu_state.main_menu_pos;
 
     //ROMs menu case
     } else if (menu_state.current_win == ROMS) {
 
+        prev_pos = menu_state.roms_menu_pos;
         disp_roms_up();
         if (menu_state.roms_menu_pos != 0) {
             menu_state.roms_menu_pos -= 1;
         }
+        return prev_pos != menu_state.roms_menu_pos;
 
     //info menu case
     } else if (menu_state.current_win == INFO) {
 
-        disp_info_up();
+        return disp_info_up();
+
+    //diagnostics menu case
+    } else if (menu_state.current_win == DIAG) {
+
+        return disp_diag_up();
 
     } //end if
 
-    redraw();
-    disp_refresh();
+    return false;
+}
+
+
+//handle a net number of down (positive) or up (negative) inputs
+void handle_move(int delta) {
+
+    //stop early once the selection can't move any further
+    for (; delta > 0; --delta) { if (_move_down() == false) break; }
+    for (; delta < 0; ++delta) { if (_move_up() == false) break; }
+    if (menu_state.current_win == ROMS) _track_roms_sel();
+
+    menu_state.needs_redraw = true;
+    return;
+}
+
+
+//handle a change of the ROM list
+void handle_roms_change() {
+
+    int ret, item_idx, name_len;
+    const char * name;
+    char * sel;
+    struct rom_item item;
+
+
+    //only the ROMs window shows the list
+    if (menu_state.current_win != ROMS) return;
+
+    //follow the selected item if it moved
+    sel = menu_state.roms_menu_sel;
+    if (sel[0] != '\0') {
+
+        item_idx = menu_state.roms_menu_pos - ROMS_MENU_OPTS;
+        ret      = get_rom_item(item_idx, &item);
+        name     = (ret != 0) ? NULL : get_rom_item_name(&item, &name_len);
+        if (name == NULL || strncmp(name, sel, name_len) != 0
+            || sel[name_len] != '\0') {
+            item_idx = find_rom_item(sel);
+            if (item_idx != -1)
+                menu_state.roms_menu_pos = ROMS_MENU_OPTS + item_idx;
+        }
+    }
+
+    //a removed item leaves the selection on its neighbour
+    menu_state.roms_menu_pos
+        = int_clamp(menu_state.roms_menu_pos, 0,
+                    ROMS_MENU_OPTS + count_rom_items() - 1);
+    _track_roms_sel();
+    disp_roms_update();
+
+    menu_state.needs_redraw = true;
     return;
 }
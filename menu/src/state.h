@@ -1,15 +1,19 @@
 #ifndef STATE_H
 #define STATE_H
 
-//external libraries
-#include <ncurses.h>
+//kernel headers
+#include <linux/limits.h>
+
+//local headers
+#include "render.h"
 
 
 // -- [macros] --
 
-#define MAIN_MENU_OPTS 3
+#define MAIN_MENU_OPTS 4
 #define ROMS_MENU_OPTS 1
 #define INFO_MENU_OPTS 1
+#define DIAG_MENU_OPTS 1
 
 
 // -- [data] --
@@ -17,7 +21,8 @@
 enum menu_window {
     MAIN,
     ROMS,
-    INFO
+    INFO,
+    DIAG
 };
 
 //menu state
@@ -25,7 +30,8 @@ struct menu_state {
 
     //window meta-data
     enum menu_window current_win;
-    WINDOW * current_win_ptr;
+    struct rnd_surface * current_win_ptr;
+    bool needs_redraw;
 
     //main menu data
     int main_menu_pos;
@@ -33,10 +39,14 @@ struct menu_state {
     //ROMs menu data
     int roms_menu_pos;
     int roms_menu_off;
+    char roms_menu_sel[PATH_MAX]; //selected item, empty on "BACK"
 
     //info menu data
     int info_menu_pos;
     int info_menu_off;
+
+    //diagnostics menu data
+    int diag_menu_pos;
 };
 
 
@@ -61,8 +71,10 @@ void init_execve_params();
 //handle inputs
 void handle_activate();
 void handle_exit();
-void handle_down();
-void handle_up();
+void handle_move(int delta);
+
+//handle a change of the ROM list
+void handle_roms_change();
 
 
 #endif
@@ -0,0 +1,249 @@
+//C standard library
+#include <stdint.h>
+#include <string.h>
+
+//system headers
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/statvfs.h>
+#include <sys/sysinfo.h>
+
+//local headers
+#include "common.h"
+#include "data.h"
+#include "event.h"
+#include "stats.h"
+
+
+/*
+ *  NOTE: Stating filesystems may stall on a busy SD card, so
+ *        snapshots are taken by a thread of their own. The menu copies
+ *        the last snapshot under a lock held only for the copy, & is
+ *        notified of each new one. Snapshots are only taken every
+ *        interval while the menu shows them.
+ */
+
+// -- [macros] --
+
+//bytes in a megabyte
+#define MB_SZ (1024 * 1024)
+
+
+// -- [globals] --
+
+//statistics thread & the event loop it times snapshots on
+static pthread_t _stats_thread;
+static struct ev_loop _stats_loop;
+
+//statistics thread stop & refresh requests, & its snapshot timer
+static int _stats_stop_fd    = -1;
+static int _stats_refresh_fd = -1;
+static int _stats_timer_fd   = -1;
+
+//last snapshot & its lock
+static pthread_mutex_t _stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct sys_stats _stats;
+
+//the menu's loop & its notification source
+static struct ev_loop * _stats_menu_loop;
+static int _stats_ready_fd = -1;
+
+//menu's receiver of snapshots
+static stats_change_cb _stats_change_cb;
+
+
+// -- [text] --
+
+//statistics thread: take & publish a snapshot
+static void _take_snapshot() {
+
+    int ret;
+    struct sys_stats stats;
+    struct statvfs vfs;
+    struct sysinfo info;
+
+
+    memset(&stats, 0, sizeof(stats));
+
+    //the ROMs & the filesystem they are stored on
+    stats.rom_count = count_roms();
+
+    ret = statvfs(PATH_ROMS, &vfs);
+    if (ret == 0) {
+        stats.rom_free_mb  = (vfs.f_bavail * vfs.f_frsize) / MB_SZ;
+        stats.rom_total_mb = (vfs.f_blocks * vfs.f_frsize) / MB_SZ;
+    }
+
+    //memory & load
+    ret = sysinfo(&info);
+    if (ret == 0) {
+        stats.mem_free_mb  = ((uint64_t) info.freeram + info.bufferram)
+                             * info.mem_unit / MB_SZ;
+        stats.mem_total_mb = (uint64_t) info.totalram * info.mem_unit / MB_SZ;
+        stats.load         = info.loads[0] / (double) (1 << SI_LOAD_SHIFT);
+    }
+
+    stats.taken_ms = mono_ms();
+
+    //publish
+    pthread_mutex_lock(&_stats_lock);
+    _stats = stats;
+    pthread_mutex_unlock(&_stats_lock);
+
+    ev_notify(_stats_ready_fd);
+
+    return;
+}
+
+
+//statistics thread: take a snapshot every interval
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_stats_timer(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    ev_read_timer(fd);
+    _take_snapshot();
+
+    return;
+}
+
+
+//statistics thread: take a snapshot on request
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_stats_refresh(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    ev_read_notify(fd);
+    _take_snapshot();
+
+    return;
+}
+
+
+//stop the statistics thread
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_stats_stop(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    ev_read_notify(fd);
+    ev_stop(&_stats_loop);
+
+    return;
+}
+
+
+//statistics thread: take the first snapshot, then refresh until stopped
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void * _stats_thread_main(void * arg) {
+#pragma GCC diagnostic pop
+
+    _take_snapshot();
+    ev_run(&_stats_loop);
+
+    return NULL;
+}
+
+
+//pass a new snapshot on to the menu
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void _on_stats_ready(int fd, uint32_t events, void * ctx) {
+#pragma GCC diagnostic pop
+
+    ev_read_notify(fd);
+    _stats_change_cb();
+
+    return;
+}
+
+
+//start the statistics thread, which publishes to the menu's `loop`
+void init_stats(struct ev_loop * loop, stats_change_cb change_cb) {
+
+    int ret;
+
+
+    _stats_menu_loop = loop;
+    _stats_change_cb = change_cb;
+    memset(&_stats, 0, sizeof(_stats));
+
+    _stats_ready_fd = ev_add_notify(loop, _on_stats_ready, NULL);
+    if (_stats_ready_fd < 0)
+        FATAL_FAIL("Failed to create a notification source.")
+
+    //setup the statistics thread's sources
+    init_ev_loop(&_stats_loop);
+
+    _stats_stop_fd    = ev_add_notify(&_stats_loop, _on_stats_stop, NULL);
+    _stats_refresh_fd = ev_add_notify(&_stats_loop, _on_stats_refresh, NULL);
+    if (_stats_stop_fd < 0 || _stats_refresh_fd < 0)
+        FATAL_FAIL("Failed to create a notification source.")
+
+    //the timer only runs while snapshots are shown
+    _stats_timer_fd = ev_add_timer(&_stats_loop, 0, _on_stats_timer, NULL);
+    if (_stats_timer_fd < 0) FATAL_FAIL("Failed to create a timer source.")
+
+    //signals stay blocked in the statistics thread, they are read by the menu
+    ret = pthread_create(&_stats_thread, NULL, _stats_thread_main, NULL);
+    if (ret != 0) FATAL_FAIL("Failed to start the statistics thread.")
+
+    return;
+}
+
+
+//stop the statistics thread
+void fini_stats() {
+
+    ev_notify(_stats_stop_fd);
+    pthread_join(_stats_thread, NULL);
+
+    close(_stats_timer_fd);
+    close(_stats_refresh_fd);
+    close(_stats_stop_fd);
+    ev_del(_stats_menu_loop, _stats_ready_fd);
+    close(_stats_ready_fd);
+    fini_ev_loop(&_stats_loop);
+
+    return;
+}
+
+
+//take a snapshot now rather than at the next interval
+void stats_refresh() {
+
+    ev_notify(_stats_refresh_fd);
+    return;
+}
+
+
+//take a snapshot now & then every interval, until stopped
+void stats_start() {
+
+    ev_set_timer(_stats_timer_fd, STATS_REFRESH_MS, STATS_REFRESH_MS);
+    stats_refresh();
+
+    return;
+}
+
+
+//stop taking snapshots every interval
+void stats_stop() {
+
+    ev_set_timer(_stats_timer_fd, 0, 0);
+    return;
+}
+
+
+//get the last snapshot
+void stats_get(struct sys_stats * stats) {
+
+    pthread_mutex_lock(&_stats_lock);
+    *stats = _stats;
+    pthread_mutex_unlock(&_stats_lock);
+
+    return;
+}
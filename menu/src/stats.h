@@ -0,0 +1,61 @@
+#ifndef STATS_H
+#define STATS_H
+
+//C standard library
+#include <stdbool.h>
+#include <stdint.h>
+
+//local headers
+#include "event.h"
+
+
+// -- [macros] --
+
+//interval between system statistics snapshots while they are shown
+#define STATS_REFRESH_MS 5000
+
+
+// -- [data] --
+
+//system statistics snapshot
+struct sys_stats {
+
+    uint64_t taken_ms; //monotonic time taken, 0 before the first snapshot
+
+    int rom_count; //-1 if the ROMs can't be read
+
+    //space of the ROM filesystem, 0 if unknown
+    unsigned long rom_free_mb;
+    unsigned long rom_total_mb;
+
+    //memory & the 1 minute load average, 0 if unknown
+    unsigned long mem_free_mb;
+    unsigned long mem_total_mb;
+    double load;
+};
+
+
+//statistics snapshot callback
+typedef void (* stats_change_cb)();
+
+
+// -- [text] --
+
+//start the statistics thread, which publishes to the menu's `loop`
+void init_stats(struct ev_loop * loop, stats_change_cb change_cb);
+
+//stop the statistics thread
+void fini_stats();
+
+//take a snapshot now rather than at the next interval
+void stats_refresh();
+
+//take a snapshot now & then every interval, until stopped
+void stats_start();
+void stats_stop();
+
+//get the last snapshot
+void stats_get(struct sys_stats * stats);
+
+
+#endif
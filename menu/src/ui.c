@@ -0,0 +1,280 @@
+//C standard library
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+
+//external libraries
+#include <cmore.h>
+
+//local headers
+#include "common.h"
+#include "render.h"
+#include "ui.h"
+
+
+/*
+ *  NOTE: A window is laid out once per terminal size into a list of
+ *        nodes. Each render asks bound nodes for their span & only
+ *        draws those whose span differs from the one last drawn, so a
+ *        frame costs what changed rather than the whole window. The
+ *        draw-list assumes it is the only thing drawing its window.
+ *
+ *        Nodes whose span is costly to fill, such as formatted ones,
+ *        are bound with a key as well. Their span is only filled when
+ *        the key differs from the one last drawn, so an unchanged frame
+ *        formats nothing.
+ *
+ *        A span is rendered to a row of the backend's cells once, when
+ *        it changes, & copied to the surface with a single rnd_put().
+ *        Drawing a node parses no format, toggles no attributes &
+ *        converts no cells.
+ */
+
+// -- [text] --
+
+//initialise a draw-list
+void init_ui_list(struct ui_list * list, rnd_cell blank) {
+
+    int ret;
+
+
+    list->blank = blank;
+    ret = cm_new_vct(&list->nodes, sizeof(struct ui_node));
+    if (ret != 0) FATAL_FAIL("Failed to allocate a draw-list.")
+
+    return;
+}
+
+
+//release a draw-list
+void fini_ui_list(struct ui_list * list) {
+
+    cm_del_vct(&list->nodes);
+    return;
+}
+
+
+//remove every node before laying a window out again
+void ui_clear(struct ui_list * list) {
+
+    cm_vct_emp(&list->nodes);
+    return;
+}
+
+
+//render a span to a node's row
+static void _render_cells(struct ui_list * list, struct ui_node * node,
+                          const struct ui_span * span) {
+
+    int off;
+    rnd_cell cells[RND_ROW_SZ];
+
+
+    //attribute each character of each segment
+    off = 0;
+    for (int i = 0; i < span->seg_num; ++i) {
+        for (int j = 0; j < span->seg_len[i] && off < node->width; ++j) {
+            cells[off] = RND_CELL(span->text[off], span->seg_colour[i]);
+            off += 1;
+        }
+    }
+
+    //clear what a longer span left behind
+    for (; off < node->width; ++off) cells[off] = list->blank;
+
+    rnd_build_row(&node->row, cells, node->width);
+    return;
+}
+
+
+//append a node
+static int _add_node(struct ui_list * list, struct ui_node * node,
+                     int y, int x, int width) {
+
+    node->y        = y;
+    node->x        = x;
+    node->width    = (width > RND_ROW_SZ) ? RND_ROW_SZ : width;
+    node->is_drawn = false;
+
+    _render_cells(list, node, &node->span);
+    return cm_vct_apd(&list->nodes, node);
+}
+
+
+//append a static node
+int ui_add_text(struct ui_list * list, int y, int x, int width,
+                const struct ui_span * span) {
+
+    struct ui_node node;
+
+
+    node.op     = UI_OP_TEXT;
+    node.bind   = NULL;
+    node.key_cb = NULL;
+    node.arg    = 0;
+    node.key    = 0;
+    memcpy(&node.span, span, sizeof(node.span));
+
+    return _add_node(list, &node, y, x, width);
+}
+
+
+//append a node bound to some state through `bind`
+int ui_add_bind(struct ui_list * list, int y, int x, int width,
+                ui_bind_cb bind, ui_key_cb key, int arg) {
+
+    struct ui_node node;
+
+
+    node.op     = UI_OP_BIND;
+    node.bind   = bind;
+    node.key_cb = key;
+    node.arg    = arg;
+    node.key    = 0;
+    ui_span_clear(&node.span);
+
+    return _add_node(list, &node, y, x, width);
+}
+
+
+//force every node to be drawn by the next render
+void ui_invalidate(struct ui_list * list) {
+
+    struct ui_node * node;
+
+
+    for (int i = 0; i < list->nodes.len; ++i) {
+        node = cm_vct_get_p(&list->nodes, i);
+        node->is_drawn = false;
+    }
+
+    return;
+}
+
+
+//check if two spans draw the same
+static bool _span_eq(const struct ui_span * a, const struct ui_span * b) {
+
+    if (a->len != b->len || a->seg_num != b->seg_num) return false;
+
+    for (int i = 0; i < a->seg_num; ++i) {
+        if (a->seg_len[i] != b->seg_len[i]) return false;
+        if (a->seg_colour[i] != b->seg_colour[i]) return false;
+    }
+
+    return memcmp(a->text, b->text, a->len) == 0;
+}
+
+
+//draw the nodes that changed, returns their count or -1 on error
+int ui_render(struct ui_list * list, struct rnd_surface * surface) {
+
+    int ret, drawn;
+    uint64_t key;
+
+    struct ui_node * node;
+    struct ui_span span;
+
+
+    drawn = 0;
+    for (int i = 0; i < list->nodes.len; ++i) {
+
+        node = cm_vct_get_p(&list->nodes, i);
+
+        //static nodes only change with the layout
+        if (node->op == UI_OP_TEXT) {
+
+            if (node->is_drawn == true) continue;
+
+        //bound nodes are rendered again when their state changed
+        } else {
+
+            //a keyed node's state is unchanged while its key is
+            if (node->key_cb != NULL) {
+                key = node->key_cb(node->arg);
+                if (node->is_drawn == true && key == node->key) continue;
+                node->key = key;
+            }
+
+            ui_span_clear(&span);
+            node->bind(node->arg, &span);
+            if (node->is_drawn == true && _span_eq(&span, &node->span))
+                continue;
+
+            memcpy(&node->span, &span, sizeof(span));
+            _render_cells(list, node, &span);
+        }
+
+        ret = rnd_put(surface, node->y, node->x, &node->row);
+        if (ret != 0) return -1;
+
+        node->is_drawn = true;
+        drawn += 1;
+    }
+
+    return drawn;
+}
+
+
+//empty a span
+void ui_span_clear(struct ui_span * span) {
+
+    span->len     = 0;
+    span->seg_num = 0;
+    span->text[0] = '\0';
+
+    return;
+}
+
+
+//append a formatted segment to a span, truncating
+void ui_span_add(struct ui_span * span, int colour, const char * fmt, ...) {
+
+    int len, room;
+    va_list args;
+
+
+    //keep room for the terminator
+    room = UI_TEXT_SZ - span->len;
+    if (span->seg_num == UI_SEG_NUM || room <= 1) return;
+
+    va_start(args, fmt);
+    len = vsnprintf(span->text + span->len, room, fmt, args);
+    va_end(args);
+
+    //skip empty segments & keep only what fit
+    if (len <= 0) return;
+    if (len > room - 1) len = room - 1;
+
+    span->seg_len[span->seg_num]    = len;
+    span->seg_colour[span->seg_num] = colour;
+    span->seg_num += 1;
+    span->len     += len;
+
+    return;
+}
+
+
+//append a plain segment to a span, truncating
+void ui_span_put(struct ui_span * span, int colour,
+                 const char * str, int len) {
+
+    int room;
+
+
+    //keep room for the terminator
+    room = UI_TEXT_SZ - span->len;
+    if (span->seg_num == UI_SEG_NUM || room <= 1 || len <= 0) return;
+    if (len > room - 1) len = room - 1;
+
+    memcpy(span->text + span->len, str, len);
+
+    span->seg_len[span->seg_num]    = len;
+    span->seg_colour[span->seg_num] = colour;
+    span->seg_num += 1;
+    span->len     += len;
+    span->text[span->len] = '\0';
+
+    return;
+}
@@ -0,0 +1,111 @@
+#ifndef UI_H
+#define UI_H
+
+//C standard library
+#include <stdbool.h>
+#include <stdint.h>
+
+//external libraries
+#include <cmore.h>
+
+//local headers
+#include "render.h"
+
+
+// -- [macros] --
+
+//text & segment capacity of a span, wider than any window
+#define UI_TEXT_SZ 96
+#define UI_SEG_NUM 8
+
+
+// -- [data] --
+
+//one line of differently coloured segments
+struct ui_span {
+
+    int len;
+    int seg_num;
+    int seg_len[UI_SEG_NUM];
+    int seg_colour[UI_SEG_NUM];
+
+    char text[UI_TEXT_SZ];
+};
+
+
+//fill `span` from the state a node is bound to
+typedef void (* ui_bind_cb)(int arg, struct ui_span * span);
+
+//get a key that changes whenever the state a node is bound to does
+typedef uint64_t (* ui_key_cb)(int arg);
+
+
+//draw-list opcodes
+enum ui_op {
+
+    UI_OP_TEXT, //static span, drawn once per layout
+    UI_OP_BIND  //span produced by a callback, drawn whenever it changes
+};
+
+
+//draw-list node
+struct ui_node {
+
+    enum ui_op op;
+
+    //position & the columns the node owns, cleared past its span
+    int y;
+    int x;
+    int width;
+
+    ui_bind_cb bind;
+    ui_key_cb key_cb; //NULL to fill the span on every render
+    int arg;
+
+    bool is_drawn;
+    uint64_t key; //key of the span last drawn
+    struct ui_span span; //static span, or the span last drawn
+
+    //`span` rendered to `width` cells in the render backend's format
+    struct rnd_row row;
+};
+
+
+//retained draw-list of a window
+struct ui_list {
+
+    rnd_cell blank; //cell clearing the columns past a span
+    cm_vct nodes; //type: struct ui_node
+};
+
+
+// -- [text] --
+
+//initialise & release a draw-list, `blank` is usually the surface background
+void init_ui_list(struct ui_list * list, rnd_cell blank);
+void fini_ui_list(struct ui_list * list);
+
+//remove every node before laying a window out again
+void ui_clear(struct ui_list * list);
+
+//append a static or a bound node, return 0 on success; a bound node
+//with a `key` is only filled again when its key changes
+int ui_add_text(struct ui_list * list, int y, int x, int width,
+                const struct ui_span * span);
+int ui_add_bind(struct ui_list * list, int y, int x, int width,
+                ui_bind_cb bind, ui_key_cb key, int arg);
+
+//force every node to be drawn by the next render
+void ui_invalidate(struct ui_list * list);
+
+//draw the nodes that changed, returns their count or -1 on error
+int ui_render(struct ui_list * list, struct rnd_surface * surface);
+
+//empty a span & append a formatted or a plain segment to it, truncating
+void ui_span_clear(struct ui_span * span);
+void ui_span_add(struct ui_span * span, int colour, const char * fmt, ...);
+void ui_span_put(struct ui_span * span, int colour,
+                 const char * str, int len);
+
+
+#endif